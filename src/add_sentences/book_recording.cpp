@@ -0,0 +1,82 @@
+#include "book_recording.hpp"
+#include "nodeid2monad.hpp"
+
+using namespace std;
+
+
+uint32_t book_recording::add_string(string_view s)
+{
+    uint32_t pos = _strings.size();
+    _strings.append(s);
+    return pos;
+}
+
+void book_recording::new_sentence()
+{
+    _events.push_back({sentence_event, 0, false, 0, 0});
+}
+
+void book_recording::new_clause(int level, bool usethis, string_view clause_type)
+{
+    _events.push_back({clause_event, static_cast<uint8_t>(level), usethis,
+                       add_string(clause_type), static_cast<uint32_t>(clause_type.size())});
+}
+
+void book_recording::new_word(string_view nodeid, unsigned levels)
+{
+    _events.push_back({word_event, static_cast<uint8_t>(levels), false,
+                       add_string(nodeid), static_cast<uint32_t>(nodeid.size())});
+}
+
+void book_recording::new_element(const xml_reader& reader)
+{
+    if (!reader.has_attribute("Unicode"))
+        return;
+
+    string_view nodeid = reader.attribute("nodeId");
+    string_view word = reader.attribute("Unicode");
+
+    uint32_t nodeid_pos = add_string(nodeid);
+    uint32_t word_pos = add_string(word);
+
+    _unicode.push_back({nodeid_pos, static_cast<uint32_t>(nodeid.size()),
+                        word_pos, static_cast<uint32_t>(word.size())});
+}
+
+vector<pair<string_view, string_view>> book_recording::unicode_words() const
+{
+    vector<pair<string_view, string_view>> result;
+    result.reserve(_unicode.size());
+
+    for (const unicode_entry& u : _unicode)
+        result.emplace_back(get_string(u.nodeid_pos, u.nodeid_len), get_string(u.word_pos, u.word_len));
+
+    return result;
+}
+
+void book_recording::replay(sentence_handler& sentences, clause_handler* clauses) const
+{
+    for (const event& e : _events) {
+        switch (e.type) {
+          case sentence_event:
+                sentences.push(true);
+                break;
+
+          case clause_event:
+                clauses[e.levels-1].push(e.usethis, string(get_string(e.str_pos, e.str_len)));
+                break;
+
+          case word_event: {
+                int monad = nodeid2monad(get_string(e.str_pos, e.str_len));
+
+                sentences.new_monad(monad);
+
+                for (int d=0; d<8; ++d) {
+                    if (e.levels & (1<<d))
+                        clauses[d].new_monad(monad);
+                }
+                break;
+          }
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef _BOOK_RECORDING_HPP
+#define _BOOK_RECORDING_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "objects.hpp"
+#include "xml_reader.hpp"
+
+// Records the sentences, clauses and words found while walking the syntax trees of one book.
+// Monads cannot be assigned while a book is being read, because they depend on the nodeIds of all
+// books. Therefore the events are recorded and later replayed into the object handlers when the
+// nodeId index has been built.
+class book_recording {
+  public:
+    // Records the start of a sentence
+    void new_sentence();
+
+    // Records the start of a clause.
+    // Parameters:
+    //    level: The clause level (1 or higher)
+    //    usethis: True if the clause is to be included in the MQL output
+    //    clause_type: The Cat attribute of the clause
+    void new_clause(int level, bool usethis, std::string_view clause_type);
+
+    // Records a word in the current sentence.
+    // Parameters:
+    //    nodeid: The nodeId of the word
+    //    levels: Bit n is set if the word belongs to the current clause at level n+1
+    void new_word(std::string_view nodeid, unsigned levels);
+
+    // Records the nodeId and Unicode attribute of an element if it has a Unicode attribute
+    // (start_element events only)
+    void new_element(const xml_reader& reader);
+
+    // Retrieves the nodeIds and words of elements with a Unicode attribute in document order
+    std::vector<std::pair<std::string_view, std::string_view>> unicode_words() const;
+
+    // Adds the recorded sentences, clauses and words to the object handlers. The nodeId index
+    // must have been built.
+    // Parameters:
+    //    sentences: The handler for sentences
+    //    clauses: The handlers for clauses, one for each level
+    void replay(sentence_handler& sentences, clause_handler* clauses) const;
+
+  private:
+    enum event_type : uint8_t { sentence_event, clause_event, word_event };
+
+    // A recorded event. The string is stored in _strings.
+    struct event {
+        event_type type;
+        uint8_t levels;     // Clause level for clause_event; level mask for word_event
+        bool usethis;       // For clause_event
+        uint32_t str_pos;   // Clause type for clause_event; nodeId for word_event
+        uint32_t str_len;
+    };
+
+    // Position and length in _strings of a nodeId and its word
+    struct unicode_entry {
+        uint32_t nodeid_pos, nodeid_len;
+        uint32_t word_pos, word_len;
+    };
+
+    uint32_t add_string(std::string_view s);
+    std::string_view get_string(uint32_t pos, uint32_t len) const { return std::string_view(_strings).substr(pos, len); }
+
+    std::vector<event> _events;
+    std::vector<unicode_entry> _unicode;
+    std::string _strings;
+};
+
+#endif // _BOOK_RECORDING_HPP
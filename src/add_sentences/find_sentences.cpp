@@ -3,12 +3,24 @@
 #include <cctype>
 #include <cassert>
 #include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <sstream>
+#include <climits>
+#include <thread>
+#include <atomic>
 
-#include "pugixml.hpp"
+#include "xml_reader.hpp"
 #include "findfiles.hpp"
 #include "nodeid2monad.hpp"
+#include "nodeid_index.hpp"
 #include "objects.hpp"
+#include "book_recording.hpp"
 #include "walker.hpp"
+#include "../mapped_file.hpp"
+#include "../oxia2tonos.hpp"
+#include "../book_fingerprints.hpp"
+#include "../util.hpp"
 
 using namespace std;
 
@@ -17,14 +29,310 @@ using namespace std;
 static void usage(const char* progname)
 {
     cerr << "Usage:\n"
-         << progname << " [-o mqlfile]\n";
+         << progname << " [-o mqlfile] [-c coverfile] [-j threads] [-m mapfile | [-w textfile] [-b indexfile]]\n"
+         << "        [-f fingerprintfile | -u fingerprintfile]\n";
+}
+
+
+// Advances the reader to the next child element of an element. The Unicode attributes of all
+// elements passed are recorded.
+// Parameters:
+//    reader: The XML reader
+//    depth: The depth of the parent element
+//    rec: Where the Unicode attributes are recorded
+// Returns:
+//    True if the reader is at the start tag of a child element, false if the end of the parent
+//    element has been reached or the document is malformed
+
+static bool next_child(xml_reader& reader, int depth, book_recording& rec)
+{
+    for (;;) {
+        switch (reader.next()) {
+          case xml_reader::start_element:
+                rec.new_element(reader);
+                if (reader.depth()==depth+1)
+                    return true;
+                break; // Descendant of a skipped child
+
+          case xml_reader::end_element:
+                if (reader.depth()==depth)
+                    return false;
+                break;
+
+          case xml_reader::end_document:
+          case xml_reader::error:
+                return false;
+
+          default:
+                break;
+        }
+    }
+}
+
+
+// Parses the XML file of one book and walks its syntax trees, recording sentences, clauses and
+// words.
+// Parameters:
+//    path: The name of the XML file
+//    rec: Where the contents of the book are recorded
+// Returns:
+//    False if the file could not be read or parsed
+
+static bool process_book(const string& path, book_recording& rec)
+{
+    mapped_file xml{path};
+    if (!xml.is_open())
+        return false;
+
+    xml_reader reader{xml.view()};
+
+    // Find the document element
+    xml_reader::event_type ev;
+    while ((ev = reader.next())!=xml_reader::start_element) {
+        if (ev==xml_reader::end_document || ev==xml_reader::error) {
+            cerr << path << ": " << reader.error_message() << endl;
+            return false;
+        }
+    }
+    rec.new_element(reader);
+
+    simple_walker w {&rec, 2};
+
+    while (next_child(reader, 0, rec)) {
+        assert(reader.name()=="Sentence");
+
+        bool first_trees = true;
+        while (next_child(reader, 1, rec)) {
+            assert(reader.name()=="Trees");
+            if (first_trees)
+                first_trees = false;
+            else {
+                cerr << "More than one <Trees> in <Sentence>\n";
+                exit(1);
+            }
+
+            bool first_tree = true;
+            while (next_child(reader, 2, rec)) {
+                assert(reader.name()=="Tree");
+                if (!first_tree)
+                    continue; // Skip alternate <Tree> elements
+                first_tree = false;
+
+                bool first_node = true;
+                while (next_child(reader, 3, rec)) {
+                    assert(reader.name()=="Node");
+                    if (first_node)
+                        first_node = false;
+                    else {
+                        cerr << "More than one <Node> in <Tree>\n";
+                        exit(1);
+                    }
+
+                    rec.new_sentence();
+
+                    if (!w.traverse(reader))
+                        break;
+                }
+            }
+        }
+    }
+
+    if (reader.failed()) {
+        cerr << path << ": " << reader.error_message() << endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+// Builds the nodeId index from the nodeIds of the words in all books. This corresponds to the
+// contents of xmlWithNode.txt.
+// Parameters:
+//    recs: The recordings of all books
+//    text_name: If not empty, the nodeIds and words are written to this file in the same format
+//               as xmlWithNode.txt
+//    index_name: If not empty, the nodeIds and words are written to this file as a binary
+//                nodeId index
+// Returns:
+//    False if an output file could not be written
+
+static bool index_words(const vector<book_recording>& recs, const string& text_name, const string& index_name)
+{
+    // Only the first occurrence of a nodeId is used
+    vector<pair<string_view, string_view>> words;
+    for (const book_recording& rec : recs) {
+        vector<pair<string_view, string_view>> book_words = rec.unicode_words();
+        words.insert(words.end(), book_words.begin(), book_words.end());
+    }
+
+    auto by_nodeid = [](const pair<string_view, string_view>& a, const pair<string_view, string_view>& b) {
+        return a.first < b.first;
+    };
+    auto same_nodeid = [](const pair<string_view, string_view>& a, const pair<string_view, string_view>& b) {
+        return a.first == b.first;
+    };
+
+    stable_sort(words.begin(), words.end(), by_nodeid);
+    words.erase(unique(words.begin(), words.end(), same_nodeid), words.end());
+
+    if (!text_name.empty() || !index_name.empty()) {
+        // The output files contain words with oxia
+        vector<string> oxia_words;
+        oxia_words.reserve(words.size());
+        for (const pair<string_view, string_view>& w : words)
+            oxia_words.push_back(tonos2oxia(string(w.second)));
+
+        vector<pair<string_view, string_view>> oxia_pairs;
+        oxia_pairs.reserve(words.size());
+        for (size_t i=0; i<words.size(); ++i)
+            oxia_pairs.emplace_back(words[i].first, oxia_words[i]);
+
+        if (!text_name.empty()) {
+            ofstream tfile{text_name};
+            if (!tfile) {
+                cerr << "Cannot open " << text_name << endl;
+                return false;
+            }
+
+            for (const pair<string_view, string_view>& w : oxia_pairs)
+                tfile << w.first << ":" << w.second << "\n";
+        }
+
+        if (!index_name.empty() && !nodeid_index::write(index_name, oxia_pairs)) {
+            cerr << "Cannot write " << index_name << endl;
+            return false;
+        }
+    }
+
+    vector<string> nodeids;
+    nodeids.reserve(words.size());
+    for (const pair<string_view, string_view>& w : words)
+        nodeids.emplace_back(w.first);
+
+    build_nodeid2monad(move(nodeids));
+    return true;
+}
+
+
+// The objects belonging to one book, given as [first,last) index ranges in the object handlers
+struct book_extent {
+    size_t sentences_first, sentences_last;
+    size_t clauses_first[2], clauses_last[2];
+    int first_monad, last_monad;
+};
+
+
+// Writes CREATE OBJECT code for the used objects in an index range of an object handler
+static void write_objects(ostream& output, const object_handler& hand, size_t first, size_t last)
+{
+    for (size_t i=first; i<last; ++i) {
+        const monads& m = hand.get_monads()[i];
+        if (m.useit())
+            hand.mql_one_obj(output, m);
+    }
+}
+
+// Checks if an index range of an object handler contains any used objects
+static bool has_used_objects(const object_handler& hand, size_t first, size_t last)
+{
+    for (size_t i=first; i<last; ++i) {
+        if (hand.get_monads()[i].useit())
+            return true;
+    }
+    return false;
+}
+
+
+// Calculates the fingerprints of the MQL code of each book
+// Parameters:
+//    sentences: The handler for sentences
+//    clauses: The handlers for clauses, one for each level
+//    books: The names of the books
+//    extents: The objects belonging to each book
+// Returns:
+//    The fingerprints
+
+static book_fingerprints calculate_fingerprints(const sentence_handler& sentences, const clause_handler* clauses,
+                                                const vector<string>& books, const vector<book_extent>& extents)
+{
+    book_fingerprints fp;
+
+    ostringstream schema;
+    sentences.mql_head(schema);
+    for (int lev=0; lev<2; ++lev)
+        clauses[lev].mql_head(schema);
+    fp.set_schema(fnv1a(schema.str()));
+
+    for (size_t b=0; b<books.size(); ++b) {
+        const book_extent& e = extents[b];
+
+        ostringstream buf;
+        write_objects(buf, sentences, e.sentences_first, e.sentences_last);
+        for (int lev=0; lev<2; ++lev)
+            write_objects(buf, clauses[lev], e.clauses_first[lev], e.clauses_last[lev]);
+
+        fp.add_book(books[b], e.first_monad, e.last_monad, fnv1a(buf.str()));
+    }
+
+    return fp;
+}
+
+
+// Writes MQL code that replaces the sentences and clauses of the changed books in an existing
+// database
+// Parameters:
+//    output: The MQL output stream
+//    sentences: The handler for sentences
+//    clauses: The handlers for clauses, one for each level
+//    extents: The objects belonging to each book
+//    changed: The indexes of the changed books
+
+static void generate_update(ostream& output, const sentence_handler& sentences, const clause_handler* clauses,
+                            const vector<book_extent>& extents, const vector<size_t>& changed)
+{
+    output << "USE DATABASE 'nestle1904' GO\n\n";
+
+    for (size_t b : changed) {
+        const book_extent& e = extents[b];
+
+        output << "DELETE OBJECTS BY MONADS = { " << e.first_monad << "-" << e.last_monad << " }[sentence] GO\n";
+        if (has_used_objects(sentences, e.sentences_first, e.sentences_last)) {
+            sentences.mql_start_obj(output);
+            write_objects(output, sentences, e.sentences_first, e.sentences_last);
+            sentences.mql_end_obj(output);
+        }
+
+        for (int lev=0; lev<2; ++lev) {
+            output << "DELETE OBJECTS BY MONADS = { " << e.first_monad << "-" << e.last_monad << " }[clause" << lev+1 << "] GO\n";
+            if (has_used_objects(clauses[lev], e.clauses_first[lev], e.clauses_last[lev])) {
+                clauses[lev].mql_start_obj(output);
+                write_objects(output, clauses[lev], e.clauses_first[lev], e.clauses_last[lev]);
+                clauses[lev].mql_end_obj(output);
+            }
+        }
+    }
 }
 
 
 // Main function. Expects these arguments:
-//     [-o mqlfile]
+//     [-o mqlfile] [-c coverfile] [-j threads] [-m mapfile | [-w textfile] [-b indexfile]]
+//     [-f fingerprintfile | -u fingerprintfile]
 // where
 //     the generated MQL code is written to mqlfile (cout if -o is not given)
+//     the monads of sentences that are not part of any clause are written to coverfile
+//     the books are parsed in parallel using the specified number of threads
+//     the nodeId to monad mapping is read from mapfile (for example, xmlWithNode.txt generated by
+//         maketext, or a binary nodeId index) instead of being built from the syntax trees
+//     the nodeId:word pairs of the syntax trees are written to textfile, which then gets the same
+//         contents as the xmlWithNode.txt generated by maketext
+//     the nodeId:word pairs of the syntax trees are written to indexfile as a binary nodeId index
+//     -f causes the fingerprints of the books to be written to fingerprintfile
+//     -u causes MQL code to be generated that updates an existing database, replacing only the
+//         books whose fingerprints differ from those in fingerprintfile. The new fingerprints are
+//         written to fingerprintfile.new, which the caller should rename to fingerprintfile when
+//         the code has been applied. If the database cannot be updated book by book (for example,
+//         because words have been added), no code is generated and the program exits with status 2
 
 int main(int argc, char **argv)
 {
@@ -32,9 +340,18 @@ int main(int argc, char **argv)
 
     int c;
     bool oflag = false;
+    bool cflag = false;
     string output_name;  // Name of MQL file
+    string cover_name;   // Name of coverage report file
+    int threads = 1;     // Number of threads used for parsing books
+    string map_name;     // Name of nodeId to monad mapping file
+    string text_name;    // Name of nodeId:word output file
+    string index_name;   // Name of binary nodeId index output file
+    bool fflag = false;
+    bool uflag = false;
+    string fingerprint_name; // Name of fingerprint file
 
-    while ((c = getopt(argc, argv, "o:")) != -1) {
+    while ((c = getopt(argc, argv, "o:c:j:m:w:b:f:u:")) != -1) {
         switch(c) {
           case 'o':
                 if (oflag) {
@@ -45,6 +362,62 @@ int main(int argc, char **argv)
                 oflag = true;
                 output_name = optarg;
                 break;
+
+          case 'c':
+                if (cflag) {
+                    usage(argv[0]);
+                    return 1;
+                }
+
+                cflag = true;
+                cover_name = optarg;
+                break;
+
+          case 'j':
+                threads = atoi(optarg);
+                if (threads<1) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+
+          case 'm':
+                if (!map_name.empty() || !text_name.empty() || !index_name.empty()) {
+                    usage(argv[0]);
+                    return 1;
+                }
+
+                map_name = optarg;
+                break;
+
+          case 'w':
+                if (!map_name.empty() || !text_name.empty()) {
+                    usage(argv[0]);
+                    return 1;
+                }
+
+                text_name = optarg;
+                break;
+
+          case 'b':
+                if (!map_name.empty() || !index_name.empty()) {
+                    usage(argv[0]);
+                    return 1;
+                }
+
+                index_name = optarg;
+                break;
+
+          case 'f':
+          case 'u':
+                if (fflag || uflag) {
+                    usage(argv[0]);
+                    return 1;
+                }
+
+                (c=='f' ? fflag : uflag) = true;
+                fingerprint_name = optarg;
+                break;
                 
           case '?':
                 usage(argv[0]);
@@ -66,84 +439,160 @@ int main(int argc, char **argv)
     sentence_handler sentences;
     clause_handler clauses[2] {1,2};
 
-    build_nodeid2monad();
-
-    simple_walker w {&sentences, clauses, 2};
     vector<string> filenames;
     string xml_dir{"../../greek-new-testament/syntax-trees/nestle1904/xml/"};
 
     findfiles(xml_dir, filenames);
 
-    sentences.mql_head(output);
-    for (const clause_handler& chand : clauses)
-        chand.mql_head(output);
-
-    int monad = 0;
-
-    for (string xmlfile : filenames) {
+    vector<string> books;
+    for (const string& xmlfile : filenames) {
 //        if (xmlfile!="03-luke.xml") continue; // For debugging
-        
+
         if (!isdigit(xmlfile[0]) || !isdigit(xmlfile[1]))
             continue; // we only want the files 01-matthew.xml to 27-revelation.xml
 
-        
-        pugi::xml_document doc;
-        if (!doc.load_file((xml_dir + xmlfile).c_str())) return -1;
+        books.push_back(xmlfile);
+    }
 
-        cerr << xmlfile << endl;
+    // Each book is parsed into its own recording. With more than one thread, a pool of workers
+    // parses the books in parallel.
+    // The recordings of all books are held until the nodeId index has been built, because the
+    // monads depend on the nodeIds of all books. Each recording is released when it has been
+    // replayed.
+    vector<book_recording> recs(books.size());
+    vector<char> loaded(books.size(), false);
+    atomic<size_t> next_book{0};
 
-        for (pugi::xml_node sentence : doc.document_element().children()) {
-            assert(strcmp(sentence.name(), "Sentence")==0);
+    auto worker = [&]() {
+        for (size_t b = next_book++; b<books.size(); b = next_book++)
+            loaded[b] = process_book(xml_dir + books[b], recs[b]);
+    };
 
-            bool first_trees = true;
-            for (pugi::xml_node trees : sentence) {
-                assert(strcmp(trees.name(), "Trees")==0);
-                if (first_trees)
-                    first_trees = false;
-                else {
-                    cerr << "More than one <Trees> in <Sentence>\n";
-                    exit(1);
-                }
-                    
-
-                for (pugi::xml_node tree : trees) {
-                    assert(strcmp(tree.name(), "Tree")==0);
-
-                    bool first_node = true;
-                    for (pugi::xml_node node : tree) {
-                        assert(strcmp(node.name(), "Node")==0);
-                        if (first_node)
-                            first_node = false;
-                        else {
-                            cerr << "More than one <Node> in <Tree>\n";
-                            exit(1);
-                        }
-                        
-                        sentences.push(true);
-
-                        node.traverse(w);
-                    }
-                    break; // Skip alternate <Tree> elements
-                }
-            }
-        }
+    if (threads==1)
+        worker();
+    else {
+        vector<thread> pool;
+        for (int t=0; t<threads; ++t)
+            pool.emplace_back(worker);
+        for (thread& t : pool)
+            t.join();
     }
 
-    sentences.mql_start_obj(output);
-    for (const monads& cl : sentences.get_monads()) {
-        if (cl.useit())
-            sentences.mql_one_obj(output, cl);
+    for (size_t b=0; b<books.size(); ++b) {
+        if (!loaded[b]) return -1;
     }
-    sentences.mql_end_obj(output);
 
+    if (!map_name.empty())
+        build_nodeid2monad(map_name);
+    else if (!index_words(recs, text_name, index_name))
+        return 1;
+
+    vector<book_extent> extents(books.size());
+
+    for (size_t b=0; b<books.size(); ++b) {
+        cerr << books[b] << endl;
+
+        book_extent& e = extents[b];
+        e.sentences_first = sentences.get_monads().size();
+        for (int lev=0; lev<2; ++lev)
+            e.clauses_first[lev] = clauses[lev].get_monads().size();
+
+        recs[b].replay(sentences, clauses);
+        recs[b] = book_recording{};
+
+        e.sentences_last = sentences.get_monads().size();
+        for (int lev=0; lev<2; ++lev)
+            e.clauses_last[lev] = clauses[lev].get_monads().size();
+
+        e.first_monad = INT_MAX;
+        e.last_monad = 0;
+        for (size_t i=e.sentences_first; i<e.sentences_last; ++i) {
+            e.first_monad = min(e.first_monad, sentences.get_monads()[i].get_min());
+            e.last_monad = max(e.last_monad, sentences.get_monads()[i].get_max());
+        }
+    }
+
+    book_fingerprints fingerprints;
+    vector<size_t> changed; // Indexes of changed books
+
+    if (fflag || uflag)
+        fingerprints = calculate_fingerprints(sentences, clauses, books, extents);
+
+    if (uflag) {
+        book_fingerprints old_fingerprints;
+        if (!old_fingerprints.load(fingerprint_name)) {
+            cerr << "Cannot read " << fingerprint_name << ". Full rebuild required" << endl;
+            return 2;
+        }
+
+        if (!fingerprints.changed_books(old_fingerprints, changed)) {
+            cerr << "The books cannot be updated individually. Full rebuild required" << endl;
+            return 2;
+        }
+
+        cerr << changed.size() << " book(s) changed" << endl;
+
+        generate_update(output, sentences, clauses, extents, changed);
+    }
+    else {
+        sentences.mql_head(output);
+        for (const clause_handler& chand : clauses)
+            chand.mql_head(output);
 
-    for (const clause_handler& chand : clauses) {
-        chand.mql_start_obj(output);
-        for (const monads& cl : chand.get_monads()) {
+        sentences.mql_start_obj(output);
+        for (const monads& cl : sentences.get_monads()) {
             if (cl.useit())
-                chand.mql_one_obj(output, cl);
+                sentences.mql_one_obj(output, cl);
+        }
+        sentences.mql_end_obj(output);
+
+
+        for (const clause_handler& chand : clauses) {
+            chand.mql_start_obj(output);
+            for (const monads& cl : chand.get_monads()) {
+                if (cl.useit())
+                    chand.mql_one_obj(output, cl);
+            }
+            chand.mql_end_obj(output);
         }
-        chand.mql_end_obj(output);
     }
 
+    if (!output) {
+        cerr << "Error writing MQL code" << endl;
+        return 1;
+    }
+
+    if (fflag || uflag) {
+        // The fingerprint file must describe the database, so the new fingerprints of an update
+        // are kept apart until the code has been applied
+        string name = uflag ? fingerprint_name + ".new" : fingerprint_name;
+        if (!fingerprints.save(name)) {
+            cerr << "Cannot write " << name << endl;
+            return 1;
+        }
+    }
+
+    if (cflag) {
+        ofstream cfile{cover_name};
+        if (!cfile) {
+            cerr << "Cannot open " << cover_name << endl;
+            return 1;
+        }
+
+        // Find the monads that belong to a sentence but not to any clause
+        monad_bitmap uncovered = sentences.covered();
+        monad_bitmap in_clauses;
+        for (const clause_handler& chand : clauses)
+            in_clauses |= chand.covered();
+        uncovered -= in_clauses;
+
+        for (const pair<int,int>& pi : uncovered.runs()) {
+            if (pi.first==pi.second)
+                cfile << pi.first << "\n";
+            else
+                cfile << pi.first << "-" << pi.second << "\n";
+        }
+
+        cerr << uncovered.count() << " monads are not part of any clause\n";
+    }
 }
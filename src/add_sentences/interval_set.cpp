@@ -0,0 +1,54 @@
+#include <algorithm>
+
+#include "interval_set.hpp"
+
+using namespace std;
+
+
+bool interval_set::insert(int value)
+{
+    // Fast path: Value follows the existing values
+    if (_runs.empty() || value>_runs.back().second) {
+        if (!_runs.empty() && value==_runs.back().second+1)
+            _runs.back().second = value;
+        else
+            _runs.emplace_back(value, value);
+        return true;
+    }
+
+    // Find the first run that starts after value
+    auto next = upper_bound(begin(_runs), end(_runs), value,
+                            [](int v, const pair<int,int>& run) { return v<run.first; });
+
+    if (next!=begin(_runs)) {
+        auto prev = next-1;
+
+        if (value<=prev->second)
+            return false; // Already present
+
+        if (value==prev->second+1) {
+            prev->second = value;
+            if (next!=end(_runs) && next->first==value+1) {
+                // Value fills the gap between two runs
+                prev->second = next->second;
+                _runs.erase(next);
+            }
+            return true;
+        }
+    }
+
+    if (next!=end(_runs) && next->first==value+1)
+        next->first = value;
+    else
+        _runs.insert(next, pair{value, value});
+
+    return true;
+}
+
+bool interval_set::contains(int value) const
+{
+    auto next = upper_bound(begin(_runs), end(_runs), value,
+                            [](int v, const pair<int,int>& run) { return v<run.first; });
+
+    return next!=begin(_runs) && value<=(next-1)->second;
+}
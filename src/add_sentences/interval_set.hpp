@@ -0,0 +1,33 @@
+#ifndef _INTERVAL_SET_HPP
+#define _INTERVAL_SET_HPP
+
+#include <utility>
+#include <vector>
+
+// A set of integers stored as a sorted vector of runs. Each run is a [first,last] pair of
+// consecutive integers; runs never overlap or touch each other.
+// Adding integers in increasing order is fast, as it only extends or appends to the last run.
+class interval_set {
+  public:
+    // Adds an integer to the set.
+    // Returns:
+    //    False if the integer was already in the set
+    bool insert(int value);
+
+    // Checks if an integer is in the set
+    bool contains(int value) const;
+
+    bool empty() const { return _runs.empty(); }
+
+    // Retrieves the smallest and the largest integer in the set. The set must not be empty.
+    int min() const { return _runs.front().first; }
+    int max() const { return _runs.back().second; }
+
+    // Retrieves the runs of the set in increasing order
+    const std::vector<std::pair<int,int>>& runs() const { return _runs; }
+
+  private:
+    std::vector<std::pair<int,int>> _runs;
+};
+
+#endif // _INTERVAL_SET_HPP
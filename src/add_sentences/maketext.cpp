@@ -7,26 +7,45 @@
 #include <map>
 
 #include "findfiles.hpp"
-#include "pugixml.hpp"
+#include "xml_reader.hpp"
+#include "nodeid_index.hpp"
 #include "../oxia2tonos.hpp"
+#include "../mapped_file.hpp"
 
 using namespace std;
 
-class simple_walker : public pugi::xml_tree_walker {
+class unicode_collector {
   public:
 
-    // This function is called for every XML element
-    virtual bool for_each(pugi::xml_node& node) {
-        if (node.type()==pugi::node_element) {
-            pugi::xml_attribute unicode = node.attribute("Unicode");
-            if (!unicode.empty()) {
-                string nodeId = node.attribute("nodeId").value();
-                if (!values.contains(nodeId))  // Use only the first occurrence of a word
-                    values[nodeId] = unicode.value();
+    // Reads all elements of an XML document and collects the Unicode attribute of each word.
+    // Returns:
+    //     False if the document is malformed
+    bool collect(xml_reader& reader) {
+        for (;;) {
+            switch (reader.next()) {
+              case xml_reader::start_element:
+                    if (reader.has_attribute("Unicode")) {
+                        string nodeId{reader.attribute("nodeId")};
+                        if (!values.contains(nodeId))  // Use only the first occurrence of a word
+                            values[nodeId] = reader.attribute("Unicode");
+                    }
+                    break;
+
+              case xml_reader::end_element:
+                    if (reader.depth()==0)
+                        return true; // End of the document element
+                    break;
+
+              case xml_reader::end_document:
+                    return true;
+
+              case xml_reader::error:
+                    return false;
+
+              default:
+                    break;
             }
         }
-    
-        return true;
     }
  
     void printit(ostream& ofile) {
@@ -34,6 +53,21 @@ class simple_walker : public pugi::xml_tree_walker {
             ofile << s.first << ":" << tonos2oxia(s.second) << "\n";
     }
 
+    bool writeindex(const string& filename) {
+        vector<string> oxia_words;
+        oxia_words.reserve(values.size());
+        for (const pair<const string,string>& s : values)
+            oxia_words.push_back(tonos2oxia(s.second));
+
+        vector<pair<string_view,string_view>> words;
+        words.reserve(values.size());
+        size_t i = 0;
+        for (const pair<const string,string>& s : values)
+            words.emplace_back(s.first, oxia_words[i++]);
+
+        return nodeid_index::write(filename, words);
+    }
+
   private:
     map<string,string> values;
 };
@@ -42,13 +76,15 @@ class simple_walker : public pugi::xml_tree_walker {
 static void usage(const char* progname)
 {
     cerr << "Usage:\n"
-         << progname << " [-o textfile]\n";
+         << progname << " [-o textfile] | -b -o indexfile\n";
 }
 
 
 
 // Main function. Expects these arguments:
-//     [-o outputfile]
+//     [-o outputfile] | -b -o outputfile
+// where
+//     -b writes a binary nodeId index instead of a text file
 
 int main(int argc, char **argv)
 {
@@ -56,9 +92,10 @@ int main(int argc, char **argv)
 
     int c;
     bool oflag = false;
+    bool bflag = false;
     string output_name;  // Name of text file
 
-    while ((c = getopt(argc, argv, "o:")) != -1) {
+    while ((c = getopt(argc, argv, "o:b")) != -1) {
         switch(c) {
           case 'o':
                 if (oflag) {
@@ -69,6 +106,10 @@ int main(int argc, char **argv)
                 oflag = true;
                 output_name = optarg;
                 break;
+
+          case 'b':
+                bflag = true;
+                break;
                 
           case '?':
                 usage(argv[0]);
@@ -76,8 +117,13 @@ int main(int argc, char **argv)
         }
     }
 
+    if (bflag && !oflag) {
+        usage(argv[0]);
+        return 1;
+    }
+
     ofstream ofile;
-    if (oflag) {
+    if (oflag && !bflag) {
         ofile.open(output_name);
         if (!ofile) {
             cerr << "Cannot open " << output_name << endl;
@@ -85,7 +131,7 @@ int main(int argc, char **argv)
         }
     }
 
-    simple_walker w;
+    unicode_collector w;
 
     vector<string> filenames;
     string xml_dir{"../../greek-new-testament/syntax-trees/nestle1904/xml/"};
@@ -96,11 +142,22 @@ int main(int argc, char **argv)
         if (!isdigit(xmlfile[0]) || !isdigit(xmlfile[1]))
             continue; // we only want the files 01-matthew.xml to 27-revelation.xml
 
-        pugi::xml_document doc;
-        if (!doc.load_file((xml_dir + xmlfile).c_str())) return -1;
+        mapped_file xml{xml_dir + xmlfile};
+        if (!xml.is_open()) return -1;
 
-        doc.document_element().traverse(w);
+        xml_reader reader{xml.view()};
+        if (!w.collect(reader)) {
+            cerr << xmlfile << ": " << reader.error_message() << endl;
+            return -1;
+        }
     }
 
-    w.printit(oflag ? ofile : cout);
+    if (bflag) {
+        if (!w.writeindex(output_name)) {
+            cerr << "Cannot write " << output_name << endl;
+            return 1;
+        }
+    }
+    else
+        w.printit(oflag ? ofile : cout);
 }
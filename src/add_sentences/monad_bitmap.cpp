@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <bit>
+
+#include "monad_bitmap.hpp"
+
+using namespace std;
+
+
+void monad_bitmap::set_range(int first, int last)
+{
+    if (first>last)
+        return;
+
+    size_t fw = static_cast<size_t>(first) / 64;
+    size_t lw = static_cast<size_t>(last) / 64;
+
+    if (lw>=_words.size())
+        _words.resize(lw+1);
+
+    uint64_t fmask = ~uint64_t{0} << (first % 64);
+    uint64_t lmask = ~uint64_t{0} >> (63 - last % 64);
+
+    if (fw==lw) {
+        _words[fw] |= fmask & lmask;
+        return;
+    }
+
+    _words[fw] |= fmask;
+    fill(_words.begin()+fw+1, _words.begin()+lw, ~uint64_t{0});
+    _words[lw] |= lmask;
+}
+
+monad_bitmap& monad_bitmap::operator|=(const monad_bitmap& other)
+{
+    if (other._words.size()>_words.size())
+        _words.resize(other._words.size());
+
+    for (size_t i=0; i<other._words.size(); ++i)
+        _words[i] |= other._words[i];
+
+    return *this;
+}
+
+monad_bitmap& monad_bitmap::operator-=(const monad_bitmap& other)
+{
+    size_t n = min(_words.size(), other._words.size());
+
+    for (size_t i=0; i<n; ++i)
+        _words[i] &= ~other._words[i];
+
+    return *this;
+}
+
+size_t monad_bitmap::count() const
+{
+    size_t n = 0;
+    for (uint64_t w : _words)
+        n += popcount(w);
+    return n;
+}
+
+vector<pair<int,int>> monad_bitmap::runs() const
+{
+    vector<pair<int,int>> result;
+    bool is_in{false};
+    int low = 0;
+
+    for (size_t i=0; i<_words.size(); ++i) {
+        uint64_t w = _words[i];
+
+        // Skip words that don't change state
+        if (w==(is_in ? ~uint64_t{0} : 0))
+            continue;
+
+        for (int b=0; b<64; ++b) {
+            bool bit = w >> b & 1;
+            if (bit!=is_in) {
+                int monad = static_cast<int>(i*64) + b;
+                if (bit)
+                    low = monad;
+                else
+                    result.emplace_back(low, monad-1);
+                is_in = bit;
+            }
+        }
+    }
+
+    if (is_in)
+        result.emplace_back(low, static_cast<int>(_words.size()*64) - 1);
+
+    return result;
+}
@@ -0,0 +1,44 @@
+#ifndef _MONAD_BITMAP_HPP
+#define _MONAD_BITMAP_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// A dense set of non-negative integers (typically monads) stored as one bit per integer.
+// The bitmap grows as needed when bits are set.
+class monad_bitmap {
+  public:
+    bool test(int monad) const {
+        size_t w = static_cast<size_t>(monad) / 64;
+        return w<_words.size() && (_words[w] >> (monad % 64) & 1);
+    }
+
+    void set(int monad) {
+        size_t w = static_cast<size_t>(monad) / 64;
+        if (w>=_words.size())
+            _words.resize(w+1);
+        _words[w] |= uint64_t{1} << (monad % 64);
+    }
+
+    // Sets all bits from first to last, both inclusive
+    void set_range(int first, int last);
+
+    // Adds the bits of another bitmap to this one
+    monad_bitmap& operator|=(const monad_bitmap& other);
+
+    // Removes the bits of another bitmap from this one
+    monad_bitmap& operator-=(const monad_bitmap& other);
+
+    // Counts the number of bits set
+    size_t count() const;
+
+    // Retrieves the set bits as [first,last] runs in increasing order
+    std::vector<std::pair<int,int>> runs() const;
+
+  private:
+    std::vector<uint64_t> _words;
+};
+
+#endif // _MONAD_BITMAP_HPP
@@ -3,26 +3,77 @@
 #include <vector>
 #include <algorithm>
 #include <string>
+#include <string_view>
+#include <functional>
 #include <cstdlib>
+#include <memory>
 
 #include "nodeid2monad.hpp"
-
-#define M2N_FILE "xmlWithNode.txt"
-
+#include "nodeid_index.hpp"
 
 using namespace std;
 
 static vector<string> nodeids;
+static string nodeids_source; // Where the nodeIds came from, used in error messages
+
+// Binary nodeId index. If this is set, it is used instead of nodeids and slots.
+static unique_ptr<nodeid_index> binary_index;
+
+// Open addressing hash table mapping a nodeId to its monad. A slot value of 0 means the slot is
+// empty; otherwise the slot contains the monad, which is the index in nodeids plus 1.
+// The size of the table is a power of 2 and at least twice the number of nodeIds.
+static vector<int> slots;
+static size_t slot_mask;
+
+static size_t hash_nodeid(string_view s)
+{
+    return hash<string_view>{}(s);
+}
+
+static void build_index()
+{
+    size_t size = 16;
+    while (size < 2*nodeids.size())
+        size *= 2;
+
+    slots.assign(size, 0);
+    slot_mask = size-1;
+
+    for (size_t i=0; i<nodeids.size(); ++i) {
+        size_t ix = hash_nodeid(nodeids[i]) & slot_mask;
+
+        while (slots[ix]!=0) {
+            if (nodeids[slots[ix]-1]==nodeids[i]) {
+                cerr << "Duplicate nodeId " << nodeids[i] << " in " << nodeids_source << endl;
+                exit(1);
+            }
+            ix = (ix+1) & slot_mask;
+        }
+
+        slots[ix] = i+1;
+    }
+}
 
-void build_nodeid2monad()
+void build_nodeid2monad(const string& filename)
 {
-    ifstream ifile{M2N_FILE};
+    if (nodeid_index::is_index_file(filename)) {
+        binary_index = make_unique<nodeid_index>(filename);
+        if (!binary_index->is_open()) {
+            cerr << binary_index->error() << endl;
+            exit(1);
+        }
+        return;
+    }
+
+    ifstream ifile{filename};
 
     if (!ifile) {
-        cerr << "Cannot open " << M2N_FILE << endl;
+        cerr << "Cannot open " << filename << endl;
         exit(1);
     }
 
+    nodeids_source = filename;
+
     string line;
 
     while (getline(ifile, line)) {
@@ -30,17 +81,33 @@ void build_nodeid2monad()
 
         nodeids.emplace_back(begin(line), it);
     }
+
+    build_index();
 }
 
-int nodeid2monad(const string& s)
+void build_nodeid2monad(vector<string>&& sorted_nodeids)
 {
-    auto it = find(begin(nodeids), end(nodeids), s);
+    nodeids = move(sorted_nodeids);
+    nodeids_source = "syntax trees";
+
+    build_index();
+}
+
+int nodeid2monad(string_view s)
+{
+    if (binary_index) {
+        if (int monad = binary_index->monad(s))
+            return monad;
 
-    if (it==end(nodeids)) {
         cerr << "Cannot find nodeId " << s << endl;
         exit(1);
     }
 
-    return it - begin(nodeids) + 1; // Monad is index + 1
-}
+    for (size_t ix = hash_nodeid(s) & slot_mask; slots[ix]!=0; ix = (ix+1) & slot_mask) {
+        if (nodeids[slots[ix]-1]==s)
+            return slots[ix]; // Monad is index + 1
+    }
 
+    cerr << "Cannot find nodeId " << s << endl;
+    exit(1);
+}
@@ -2,9 +2,20 @@
 #define _NODEID2MONAD_HPP
 
 #include <string>
+#include <string_view>
+#include <vector>
 
-void build_nodeid2monad();
-int nodeid2monad(const std::string& s);
+// Reads the nodeIds from a file of nodeId:word lines, such as xmlWithNode.txt, and builds an
+// index that maps them to monads. The first nodeId in the file is monad 1.
+// If the file is a binary nodeId index (see nodeid_index.hpp), it is used directly.
+void build_nodeid2monad(const std::string& filename);
+
+// Builds an index that maps nodeIds to monads from a sorted list of nodeIds.
+// The first nodeId in the list is monad 1.
+void build_nodeid2monad(std::vector<std::string>&& sorted_nodeids);
+
+// Finds the monad corresponding to a nodeId. The program aborts if the nodeId is unknown.
+int nodeid2monad(std::string_view s);
 
 
 #endif // _NODEID2MONAD_HPP
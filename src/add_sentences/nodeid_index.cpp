@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "nodeid_index.hpp"
+#include "../util.hpp"
+
+using namespace std;
+
+
+nodeid_index::nodeid_index(const string& filename)
+    : _file{filename, mapped_file::access::normal}, // Read once for the checksum, then searched randomly
+      _entries{nullptr}, _strings{nullptr}, _count{0}
+{
+    if (!_file.is_open()) {
+        _error = "Cannot open " + filename;
+        return;
+    }
+
+    if (_file.size()<sizeof(header)) {
+        _error = filename + " is too short";
+        return;
+    }
+
+    header h;
+    memcpy(&h, _file.data(), sizeof(header));
+
+    if (memcmp(h.magic, magic, sizeof(magic))!=0) {
+        _error = filename + " is not a nodeId index";
+        return;
+    }
+
+    if (h.version!=version) {
+        _error = filename + " has unsupported version " + to_string(h.version);
+        return;
+    }
+
+    if (_file.size() != sizeof(header) + h.count*sizeof(entry) + h.strings_size) {
+        _error = filename + " has wrong size";
+        return;
+    }
+
+    string_view body = _file.view().substr(sizeof(header));
+    if (fnv1a(body)!=h.checksum) {
+        _error = filename + " has wrong checksum";
+        return;
+    }
+
+    const entry *entries = reinterpret_cast<const entry*>(_file.data() + sizeof(header));
+    const char *strings = _file.data() + sizeof(header) + h.count*sizeof(entry);
+
+    for (size_t i=0; i<h.count; ++i) {
+        if (entries[i].nodeid_pos + uint64_t{entries[i].nodeid_len} > h.strings_size ||
+            entries[i].word_pos + uint64_t{entries[i].word_len} > h.strings_size) {
+            _error = filename + " has a string outside the string table";
+            return;
+        }
+    }
+
+    // monad() uses a binary search, so the nodeIds must be sorted and unique
+    for (size_t i=1; i<h.count; ++i) {
+        if (string_view{strings+entries[i-1].nodeid_pos, entries[i-1].nodeid_len} >=
+            string_view{strings+entries[i].nodeid_pos, entries[i].nodeid_len}) {
+            _error = filename + " has unsorted or duplicate nodeIds";
+            return;
+        }
+    }
+
+    _entries = entries;
+    _strings = strings;
+    _count = h.count;
+}
+
+bool nodeid_index::is_index_file(const string& filename)
+{
+    ifstream ifile{filename, ios::binary};
+    char buf[sizeof(magic)];
+
+    return ifile.read(buf, sizeof(buf)) && memcmp(buf, magic, sizeof(magic))==0;
+}
+
+bool nodeid_index::write(const string& filename, const vector<pair<string_view, string_view>>& words)
+{
+    vector<entry> entries;
+    string strings;
+
+    entries.reserve(words.size());
+
+    for (const pair<string_view, string_view>& w : words) {
+        entry e;
+        e.nodeid_pos = strings.size();
+        e.nodeid_len = w.first.size();
+        strings.append(w.first);
+        e.word_pos = strings.size();
+        e.word_len = w.second.size();
+        strings.append(w.second);
+        e.monad = entries.size()+1;
+        entries.push_back(e);
+    }
+
+    string_view entry_bytes{reinterpret_cast<const char*>(entries.data()), entries.size()*sizeof(entry)};
+
+    header h;
+    memcpy(h.magic, magic, sizeof(magic));
+    h.version = version;
+    h.count = entries.size();
+    h.strings_size = strings.size();
+    h.checksum = fnv1a(strings, fnv1a(entry_bytes));
+
+    ofstream ofile{filename, ios::binary};
+    if (!ofile)
+        return false;
+
+    ofile.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    ofile.write(entry_bytes.data(), entry_bytes.size());
+    ofile.write(strings.data(), strings.size());
+
+    return ofile.good();
+}
+
+int nodeid_index::monad(string_view nodeid) const
+{
+    const entry *end = _entries + _count;
+    const entry *e = lower_bound(_entries, end, nodeid,
+                                 [this](const entry& e, string_view s) { return get_string(e.nodeid_pos, e.nodeid_len) < s; });
+
+    if (e==end || get_string(e->nodeid_pos, e->nodeid_len)!=nodeid)
+        return 0;
+
+    return e->monad;
+}
@@ -0,0 +1,87 @@
+#ifndef _NODEID_INDEX_HPP
+#define _NODEID_INDEX_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../mapped_file.hpp"
+
+// A binary file mapping nodeIds to monads and words. It contains the same information as
+// xmlWithNode.txt, but can be memory-mapped and used without parsing.
+//
+// File layout (all integers in native byte order):
+//     header
+//     entry[count], sorted by nodeId
+//     string table of strings_size bytes holding the nodeIds and words
+// The checksum in the header is the FNV-1a hash of the entries and the string table.
+class nodeid_index {
+  public:
+    static constexpr char magic[8] = {'N','O','D','E','I','D','X','\0'};
+    static constexpr uint32_t version = 1;
+
+    struct header {
+        char magic[8];
+        uint32_t version;
+        uint32_t count;         // Number of entries
+        uint64_t strings_size;  // Size of string table
+        uint64_t checksum;
+    };
+
+    struct entry {
+        uint32_t nodeid_pos;    // Position of nodeId in string table
+        uint32_t nodeid_len;
+        uint32_t word_pos;      // Position of word in string table
+        uint32_t word_len;
+        int32_t monad;
+    };
+
+    // Constructor. Maps and validates an index file. Use is_open() to check for success.
+    // Parameter:
+    //    filename: Name of the index file
+    nodeid_index(const std::string& filename);
+
+    // Returns true if the file was successfully mapped and validated
+    bool is_open() const { return _entries!=nullptr; }
+
+    // Retrieves a description of the problem if is_open() returns false
+    const std::string& error() const { return _error; }
+
+    // Checks if a file starts with the magic bytes of an index file
+    static bool is_index_file(const std::string& filename);
+
+    // Writes an index file.
+    // Parameters:
+    //    filename: Name of the index file
+    //    words: nodeIds and words sorted by nodeId. The first nodeId is monad 1, the next
+    //           monad 2, etc.
+    // Returns:
+    //    False if the file could not be written
+    static bool write(const std::string& filename,
+                      const std::vector<std::pair<std::string_view, std::string_view>>& words);
+
+    size_t size() const { return _count; }
+
+    // Finds the monad corresponding to a nodeId.
+    // Returns:
+    //    The monad, or 0 if the nodeId is not in the index
+    int monad(std::string_view nodeid) const;
+
+    // Retrieves the nodeId, word and monad of the entry with a given index (0<=ix<size())
+    std::string_view nodeid(size_t ix) const { return get_string(_entries[ix].nodeid_pos, _entries[ix].nodeid_len); }
+    std::string_view word(size_t ix) const { return get_string(_entries[ix].word_pos, _entries[ix].word_len); }
+    int monad_at(size_t ix) const { return _entries[ix].monad; }
+
+  private:
+    std::string_view get_string(uint32_t pos, uint32_t len) const { return {_strings+pos, len}; }
+
+    mapped_file _file;
+    const entry *_entries;
+    const char *_strings;
+    size_t _count;
+    std::string _error;
+};
+
+#endif // _NODEID_INDEX_HPP
@@ -15,72 +15,42 @@ using namespace std;
 
 void monads::new_monad(int monad)
 {
-    if (_si.count(monad)>0)
+    if (!_si.insert(monad))
         throw invalid_argument("Collection has " + to_string(monad));
 
     if (monad>_max)
         _max = monad;
     if (monad<_min)
         _min = monad;
-    _si.insert(monad);
 }
 
 bool monads::is_consecutive(int& init) const
 {
-    for (int x : _si) {
-        if (x != ++init) {
-            cerr << "Expect " << init << " got " << x << endl;
+    // Within a run the monads are consecutive, so only the start of each run needs checking
+    for (const pair<int,int>& run : _si.runs()) {
+        if (run.first != ++init) {
+            cerr << "Expect " << init << " got " << run.first << endl;
             return false;
         }
+        init = run.second;
     }
     return true;
 }
 
 bool monads::is_covering(int& init) const
 {
-    bool first = true;
-
-    for (int x : _si) {
-        if (first) {
-            if (x != ++init) {
-                cerr << "Expect " << init << " got " << x << endl;
-                return false;
-            }
-            first = false;
-        }
-        else
-            init = x;
+    if (_si.empty())
+        return true;
+
+    if (_si.min() != ++init) {
+        cerr << "Expect " << init << " got " << _si.min() << endl;
+        return false;
     }
+    init = _si.max();
     return true;
 }
 
 
-const vector<pair<int,int>>& monads::get_segments() const
-{
-    if (_segments.empty()) {
-        int low;
-
-        bool is_in{false};
-        for (int i=_min; i<=_max; ++i) {
-            if (_si.count(i)>0) {
-                if (!is_in) {
-                    low = i;
-                    is_in = true;
-                }
-            }
-            else {
-                if (is_in) {
-                    _segments.emplace_back(low, i-1);
-                    is_in = false;
-                }
-            }
-        }
-        if (is_in)
-            _segments.emplace_back(low,_max);
-    }
-    return _segments;
-}
-
 void object_handler::push(bool usethis)
 {
     _objects.emplace_back(usethis);
@@ -194,8 +164,22 @@ void object_handler::mql_end_obj(ostream& output) const
 
 void object_handler::new_monad(int monad)
 {
-    if (_allmonads.count(monad)>0)
+    if (_allmonads.test(monad))
         return;
 
     _objects.back().new_monad(monad);
 }
+
+monad_bitmap object_handler::covered() const
+{
+    monad_bitmap result;
+
+    for (const monads& m : _objects) {
+        if (m.useit()) {
+            for (const pair<int,int>& pi : m.get_segments())
+                result.set_range(pi.first, pi.second);
+        }
+    }
+
+    return result;
+}
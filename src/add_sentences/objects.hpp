@@ -2,13 +2,15 @@
 #define _OBJECTS_HPP
 
 #include <climits>
-#include <set>
 #include <vector>
 #include <utility>
 #include <fstream>
 #include <map>
 #include <string>
 
+#include "interval_set.hpp"
+#include "monad_bitmap.hpp"
+
 class monads {
   public:
     monads(bool usethis) : _min{INT_MAX}, _max{0}, _usethis{usethis} {}
@@ -18,21 +20,20 @@ class monads {
     bool is_consecutive(int& init) const;
     bool is_covering(int& init) const;
 
-    const std::set<int>& get_monads() const { return _si; }
+    const interval_set& get_monads() const { return _si; }
     int get_min() const { return _min; }
     int get_max() const { return _max; }
     bool useit() const { return _usethis; }
 
-    const std::vector<std::pair<int,int>>& get_segments() const;
+    const std::vector<std::pair<int,int>>& get_segments() const { return _si.runs(); }
     std::map<std::string, std::string>& features() { return _features; }
     const std::map<std::string, std::string>& features() const { return _features; }
 
   private:
     int _min;
     int _max;
-    std::set<int> _si;
+    interval_set _si;
     bool _usethis;
-    mutable std::vector<std::pair<int,int>> _segments;
     std::map<std::string, std::string> _features;
 };
 
@@ -46,11 +47,14 @@ class object_handler {
     virtual void mql_fields(std::ostream& output, const monads &m) const;
     void new_monad(int monad);
 
+    // Retrieves the monads of all objects that are used in the MQL output
+    monad_bitmap covered() const;
+
   protected:
     std::vector<monads> _objects; // All objects of this type
 
   private:
-    std::set<int> _allmonads; // Keeps track of which monads have been used and should be omitted from subsequent objects
+    monad_bitmap _allmonads; // Keeps track of which monads have been used and should be omitted from subsequent objects
 };
 
 class sentence_handler : public object_handler {
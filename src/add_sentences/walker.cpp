@@ -1,17 +1,11 @@
 #include <cassert>
 #include <stdexcept>
 
-#include "nodeid2monad.hpp"
 #include "walker.hpp"
 
 using namespace std;
 
-static const char* node_types[] =
-{
-    "null", "document", "element", "pcdata", "cdata", "comment", "pi", "declaration"
-};
-
-static bool all_uc(const string& s)
+static bool all_uc(string_view s)
 {
     for (char c : s)
         if (c>='a' && c<='z')
@@ -20,37 +14,66 @@ static bool all_uc(const string& s)
 }
 
 
-bool simple_walker::for_each(pugi::xml_node& node)
+bool simple_walker::traverse(xml_reader& reader)
 {
-    int dep = depth();
+    int top = reader.depth();   // Depth of the <Node> element
+    size_t open = 1;            // Number of open elements in _nodeids
 
-    if (node.type()==pugi::node_element &&
-        dep>=1 && dep<=_numlev) {
-        _haslev[dep-1] = true;
-        for (int d=dep; d<_numlev; ++d)
-            _haslev[d] = false;
+    if (_nodeids.empty())
+        _nodeids.resize(1);
+    _nodeids[0] = reader.attribute("nodeId");
 
-        string cat{node.attribute("Cat").value()};
+    for (;;) {
+        switch (reader.next()) {
+          case xml_reader::start_element: {
+                // Direct children of the <Node> element have depth 0
+                int dep = reader.depth() - top - 1;
 
-        _chands[dep-1].push(all_uc(cat), cat);
-    }
+                if (dep>=1 && dep<=_numlev) {
+                    _haslev[dep-1] = true;
+                    for (int d=dep; d<_numlev; ++d)
+                        _haslev[d] = false;
+
+                    string_view cat = reader.attribute("Cat");
+
+                    _rec->new_clause(dep, all_uc(cat), cat);
+                }
 
-    if (node.type()==pugi::node_pcdata) {
-        pugi::xml_node p = node.parent();
-        assert(!p.empty());
+                _rec->new_element(reader);
 
-        pugi::xml_attribute a = p.attribute("nodeId");
-        assert(!a.empty());
+                if (open==_nodeids.size())
+                    _nodeids.emplace_back();
+                _nodeids[open++] = reader.attribute("nodeId");
+                break;
+          }
 
-        int monad = nodeid2monad(a.value());
+          case xml_reader::end_element:
+                if (reader.depth()==top)
+                    return true;
+                --open;
+                break;
 
-        _shand->new_monad(monad);
+          case xml_reader::text: {
+                // The nodeId of the parent element identifies the word
+                const string& nodeid = _nodeids[open-1];
+                assert(!nodeid.empty());
 
-        for (int d=0; d<_numlev; ++d) {
-            if (_haslev[d])
-                _chands[d].new_monad(monad);
+                unsigned levels = 0;
+                for (int d=0; d<_numlev; ++d) {
+                    if (_haslev[d])
+                        levels |= 1u << d;
+                }
+
+                _rec->new_word(nodeid, levels);
+                break;
+          }
+
+          case xml_reader::cdata:
+                break;
+
+          case xml_reader::end_document:
+          case xml_reader::error:
+                return false;
         }
     }
-
-    return true; // continue traversal
 }
@@ -1,24 +1,33 @@
 #ifndef _WALKER_HPP
 #define _WALKER_HPP
 
-#include <set>
+#include <string>
+#include <vector>
 
-#include "pugixml.hpp"
-#include "objects.hpp"
+#include "xml_reader.hpp"
+#include "book_recording.hpp"
 
 
-class simple_walker : public pugi::xml_tree_walker {
+class simple_walker {
   public:
-    simple_walker(sentence_handler *shand, clause_handler *chands, int numlev)
-        : _shand{shand}, _chands{chands}, _numlev{numlev}, _haslev{new bool[_numlev]} {}
+    simple_walker(book_recording *rec, int numlev)
+        : _rec{rec}, _numlev{numlev}, _haslev{new bool[_numlev]()} {}
 
-    virtual bool for_each(pugi::xml_node& node);
+    simple_walker(const simple_walker&) = delete;
+    ~simple_walker() { delete[] _haslev; }
+
+    // Walks the descendants of a <Node> element, recording clauses and words.
+    // On entry, the reader must be positioned at the start tag of the <Node>; on exit, it is
+    // positioned at the matching end tag.
+    // Returns:
+    //     False if the document is malformed
+    bool traverse(xml_reader& reader);
 
   private:
-    sentence_handler *_shand;
-    clause_handler *_chands;
+    book_recording *_rec;
     int _numlev;
     bool *_haslev;
+    std::vector<std::string> _nodeids; // nodeId attributes of the open elements
 };
 
 
@@ -0,0 +1,350 @@
+#include <algorithm>
+#include <charconv>
+
+#include "xml_reader.hpp"
+
+using namespace std;
+
+
+static bool is_space(char c)
+{
+    return c==' ' || c=='\t' || c=='\n' || c=='\r';
+}
+
+static void append_utf8(string& out, char32_t c)
+{
+    if (c<0x80)
+        out += static_cast<char>(c);
+    else if (c<0x800) {
+        out += static_cast<char>(0xc0 | (c>>6));
+        out += static_cast<char>(0x80 | (c & 0x3f));
+    }
+    else if (c<0x10000) {
+        out += static_cast<char>(0xe0 | (c>>12));
+        out += static_cast<char>(0x80 | ((c>>6) & 0x3f));
+        out += static_cast<char>(0x80 | (c & 0x3f));
+    }
+    else {
+        out += static_cast<char>(0xf0 | (c>>18));
+        out += static_cast<char>(0x80 | ((c>>12) & 0x3f));
+        out += static_cast<char>(0x80 | ((c>>6) & 0x3f));
+        out += static_cast<char>(0x80 | (c & 0x3f));
+    }
+}
+
+// Decodes an entity reference starting at raw[i], which is '&'.
+// Returns:
+//     The position following the reference, or i if it is not a recognized reference
+
+static size_t decode_entity(string_view raw, size_t i, string& out)
+{
+    size_t semi = raw.find(';', i);
+    if (semi==string_view::npos || semi-i>12)
+        return i;
+
+    string_view ent = raw.substr(i+1, semi-i-1);
+
+    if (ent=="lt")        out += '<';
+    else if (ent=="gt")   out += '>';
+    else if (ent=="amp")  out += '&';
+    else if (ent=="apos") out += '\'';
+    else if (ent=="quot") out += '"';
+    else if (ent.size()>1 && ent[0]=='#') {
+        uint32_t c;
+        int base = 10;
+        ent.remove_prefix(1);
+        if (ent[0]=='x') {
+            base = 16;
+            ent.remove_prefix(1);
+        }
+        auto [ptr, ec] = from_chars(ent.data(), ent.data()+ent.size(), c, base);
+        if (ec!=errc() || ptr!=ent.data()+ent.size() || c>0x10ffff)
+            return i;
+        append_utf8(out, c);
+    }
+    else
+        return i;
+
+    return semi+1;
+}
+
+// Decodes character references and line endings in text or attribute values.
+// In text, CR LF and CR are converted to LF. In attribute values, CR LF and whitespace
+// characters are converted to a space.
+
+static void decode(string_view raw, string& out, bool is_attribute)
+{
+    for (size_t i=0; i<raw.size(); ) {
+        char c = raw[i];
+
+        if (c=='&') {
+            size_t next = decode_entity(raw, i, out);
+            if (next!=i) {
+                i = next;
+                continue;
+            }
+            out += c;
+        }
+        else if (c=='\r') {
+            if (i+1<raw.size() && raw[i+1]=='\n')
+                ++i;
+            out += is_attribute ? ' ' : '\n';
+        }
+        else if (is_attribute && (c=='\n' || c=='\t'))
+            out += ' ';
+        else
+            out += c;
+
+        ++i;
+    }
+}
+
+
+xml_reader::xml_reader(string_view doc)
+    : _doc{doc}, _pos{0}, _state{start_element}, _pending_end{false}, _seen_root{false}, _depth{0}
+{
+}
+
+xml_reader::event_type xml_reader::fail(const string& msg)
+{
+    _error = msg + " at offset " + to_string(_pos);
+    _state = error;
+    return error;
+}
+
+void xml_reader::skip_space()
+{
+    while (_pos<_doc.size() && is_space(_doc[_pos]))
+        ++_pos;
+}
+
+// Moves past the next occurrence of terminator.
+// Returns:
+//     False if terminator was not found
+
+bool xml_reader::skip_past(string_view terminator)
+{
+    size_t end = _doc.find(terminator, _pos);
+    if (end==string_view::npos)
+        return false;
+
+    _pos = end + terminator.size();
+    return true;
+}
+
+// Moves past a DOCTYPE declaration, including any internal subset.
+// Returns:
+//     False if the declaration is not terminated
+
+bool xml_reader::skip_doctype()
+{
+    int brackets = 0;
+
+    while (_pos<_doc.size()) {
+        char c = _doc[_pos++];
+
+        if (c=='"' || c=='\'') {
+            size_t end = _doc.find(c, _pos);
+            if (end==string_view::npos)
+                return false;
+            _pos = end+1;
+        }
+        else if (c=='<' && _doc.substr(_pos).starts_with("!--")) {
+            if (!skip_past("-->"))
+                return false;
+        }
+        else if (c=='[')
+            ++brackets;
+        else if (c==']')
+            --brackets;
+        else if (c=='>' && brackets==0)
+            return true;
+    }
+
+    return false;
+}
+
+xml_reader::event_type xml_reader::next()
+{
+    if (_state==end_document || _state==error)
+        return _state;
+
+    _decoded.clear();
+
+    if (_pending_end) {
+        // Second event of an empty element tag. _name and _depth are unchanged.
+        _pending_end = false;
+        _open.pop_back();
+        return end_element;
+    }
+
+    while (_pos<_doc.size()) {
+        if (_doc[_pos]!='<') {
+            size_t end = min(_doc.find('<', _pos), _doc.size());
+            string_view raw = _doc.substr(_pos, end-_pos);
+            _pos = end;
+
+            if (_open.empty() || all_of(raw.begin(), raw.end(), is_space))
+                continue; // Ignore whitespace and text outside the root element
+
+            if (raw.find_first_of("&\r")!=string_view::npos) {
+                decode(raw, _decoded, false);
+                _value = _decoded;
+            }
+            else
+                _value = raw;
+
+            _depth = _open.size()-1;
+            return text;
+        }
+
+        string_view rest = _doc.substr(_pos);
+
+        if (rest.starts_with("<?")) {
+            // XML declaration or processing instruction
+            if (!skip_past("?>"))
+                return fail("Unterminated processing instruction");
+        }
+        else if (rest.starts_with("<!--")) {
+            if (!skip_past("-->"))
+                return fail("Unterminated comment");
+        }
+        else if (rest.starts_with("<![CDATA[")) {
+            size_t start = _pos+9;
+            size_t end = _doc.find("]]>", start);
+            if (end==string_view::npos)
+                return fail("Unterminated CDATA section");
+            _pos = end+3;
+
+            if (!_open.empty()) {
+                _value = _doc.substr(start, end-start);
+                _depth = _open.size()-1;
+                return cdata;
+            }
+        }
+        else if (rest.starts_with("<!DOCTYPE")) {
+            if (!skip_doctype())
+                return fail("Unterminated DOCTYPE declaration");
+        }
+        else if (rest.starts_with("</")) {
+            size_t end = _doc.find('>', _pos);
+            if (end==string_view::npos)
+                return fail("Unterminated end tag");
+
+            string_view name = _doc.substr(_pos+2, end-_pos-2);
+            while (!name.empty() && is_space(name.back()))
+                name.remove_suffix(1);
+
+            if (_open.empty() || name!=_open.back())
+                return fail("Unexpected end tag </" + string(name) + ">");
+
+            _pos = end+1;
+            _name = name;
+            _depth = _open.size()-1;
+            _open.pop_back();
+            return end_element;
+        }
+        else
+            return read_tag();
+    }
+
+    if (!_open.empty())
+        return fail("Unexpected end of document in <" + string(_open.back()) + ">");
+    if (!_seen_root)
+        return fail("No document element");
+
+    _state = end_document;
+    return end_document;
+}
+
+// Reads a start tag or an empty element tag. _pos is at the initial '<'.
+
+xml_reader::event_type xml_reader::read_tag()
+{
+    auto is_name_end = [](char c) { return is_space(c) || c=='/' || c=='>' || c=='='; };
+
+    size_t start = ++_pos;
+    while (_pos<_doc.size() && !is_name_end(_doc[_pos]))
+        ++_pos;
+
+    if (_pos==start)
+        return fail("Missing element name");
+
+    _name = _doc.substr(start, _pos-start);
+    _attrs.clear();
+
+    for (;;) {
+        skip_space();
+
+        if (_pos>=_doc.size())
+            return fail("Unterminated start tag <" + string(_name) + ">");
+
+        if (_doc[_pos]=='>') {
+            ++_pos;
+            break;
+        }
+
+        if (_doc.substr(_pos).starts_with("/>")) {
+            _pos += 2;
+            _pending_end = true;
+            break;
+        }
+
+        start = _pos;
+        while (_pos<_doc.size() && !is_name_end(_doc[_pos]))
+            ++_pos;
+
+        if (_pos==start)
+            return fail("Missing attribute name in <" + string(_name) + ">");
+
+        attr a {_doc.substr(start, _pos-start), {}, 0, 0, false};
+
+        skip_space();
+        if (_pos>=_doc.size() || _doc[_pos]!='=')
+            return fail("Missing '=' after attribute " + string(a.name));
+        ++_pos;
+        skip_space();
+
+        if (_pos>=_doc.size() || (_doc[_pos]!='"' && _doc[_pos]!='\''))
+            return fail("Missing quote in value of attribute " + string(a.name));
+
+        char quote = _doc[_pos++];
+        size_t end = _doc.find(quote, _pos);
+        if (end==string_view::npos)
+            return fail("Unterminated value of attribute " + string(a.name));
+
+        string_view raw = _doc.substr(_pos, end-_pos);
+        _pos = end+1;
+
+        if (raw.find_first_of("&\r\n\t")!=string_view::npos) {
+            a.decoded_pos = _decoded.size();
+            decode(raw, _decoded, true);
+            a.decoded_len = _decoded.size() - a.decoded_pos;
+            a.is_decoded = true;
+        }
+        else
+            a.value = raw;
+
+        _attrs.push_back(a);
+    }
+
+    _open.push_back(_name);
+    _depth = _open.size()-1;
+    _seen_root = true;
+    return start_element;
+}
+
+string_view xml_reader::attribute(string_view name) const
+{
+    for (const attr& a : _attrs) {
+        if (a.name==name)
+            return a.is_decoded ? string_view(_decoded).substr(a.decoded_pos, a.decoded_len) : a.value;
+    }
+
+    return {};
+}
+
+bool xml_reader::has_attribute(string_view name) const
+{
+    return any_of(_attrs.begin(), _attrs.end(), [name](const attr& a) { return a.name==name; });
+}
@@ -0,0 +1,89 @@
+#ifndef _XML_READER_HPP
+#define _XML_READER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A streaming pull parser for XML documents. The document is read one event at a time by calling
+// next(), so no tree is built and the memory used is bounded by the depth of the document.
+//
+// The parser handles the subset of XML used by the syntax trees: XML declarations, processing
+// instructions, comments and DOCTYPE declarations are skipped; CDATA sections are reported as
+// cdata events; text consisting only of whitespace is skipped; character references and the
+// predefined entities are decoded in text and attribute values.
+class xml_reader {
+  public:
+    enum event_type {
+        start_element,  // Start tag. An empty element tag generates a start_element and an end_element
+        end_element,    // End tag
+        text,           // Character data
+        cdata,          // CDATA section
+        end_document,   // End of the document
+        error           // Malformed document. Use error_message() to get a description
+    };
+
+    // Constructor.
+    // Parameter:
+    //    doc: The XML document. The data must remain valid for as long as the reader is used
+    xml_reader(std::string_view doc);
+
+    // Reads the next event from the document.
+    // After end_document or error is returned, all subsequent calls return the same value.
+    event_type next();
+
+    // Retrieves the depth of the current event. For start_element and end_element this is the
+    // depth of the element, where the root element has depth 0. For text and cdata this is the
+    // depth of the enclosing element.
+    int depth() const { return _depth; }
+
+    // Retrieves the name of the current element (start_element and end_element only)
+    std::string_view name() const { return _name; }
+
+    // Retrieves the value of an attribute of the current element (start_element only).
+    // Returns:
+    //     The decoded value, or an empty string if the attribute does not exist.
+    //     The value remains valid until the next call to next()
+    std::string_view attribute(std::string_view name) const;
+
+    // Checks if the current element has an attribute (start_element only)
+    bool has_attribute(std::string_view name) const;
+
+    // Retrieves the decoded text of the current text or cdata event.
+    // The value remains valid until the next call to next()
+    std::string_view value() const { return _value; }
+
+    bool failed() const { return _state==error; }
+    const std::string& error_message() const { return _error; }
+
+  private:
+    struct attr {
+        std::string_view name;
+        std::string_view value; // Raw value, or empty if decoded
+        size_t decoded_pos;     // Position of decoded value in _decoded
+        size_t decoded_len;     // Length of decoded value in _decoded
+        bool is_decoded;
+    };
+
+    event_type fail(const std::string& msg);
+    event_type read_tag();
+    bool skip_past(std::string_view terminator);
+    bool skip_doctype();
+    void skip_space();
+
+    std::string_view _doc;
+    size_t _pos;
+
+    event_type _state;          // end_document or error when the document has been completely read
+    bool _pending_end;          // True if the previous event was an empty element tag
+    bool _seen_root;            // True when the root element has been read
+    int _depth;
+    std::string_view _name;
+    std::string_view _value;
+    std::vector<std::string_view> _open;  // Names of the open elements
+    std::vector<attr> _attrs;             // Attributes of the current element
+    std::string _decoded;                 // Buffer for decoded text and attribute values
+    std::string _error;
+};
+
+#endif // _XML_READER_HPP
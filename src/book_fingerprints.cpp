@@ -0,0 +1,81 @@
+#include <fstream>
+#include <sstream>
+
+#include "book_fingerprints.hpp"
+
+using namespace std;
+
+// First line of a fingerprint file
+static const string file_header{"book_fingerprints 1"};
+
+
+void book_fingerprints::add_book(const string& name, int first_monad, int last_monad, uint64_t hash)
+{
+    m_books.push_back({name, first_monad, last_monad, hash});
+}
+
+bool book_fingerprints::load(const string& filename)
+{
+    ifstream ifile{filename};
+    if (!ifile)
+        return false;
+
+    string line;
+    if (!getline(ifile, line) || line!=file_header)
+        return false;
+
+    if (!getline(ifile, line))
+        return false;
+
+    istringstream schema_line{line};
+    string keyword;
+    if (!(schema_line >> keyword >> hex >> m_schema) || keyword!="schema")
+        return false;
+
+    m_books.clear();
+    while (getline(ifile, line)) {
+        istringstream book_line{line};
+        book b;
+        if (!(book_line >> b.name >> b.first_monad >> b.last_monad >> hex >> b.hash))
+            return false;
+        m_books.push_back(b);
+    }
+
+    return true;
+}
+
+bool book_fingerprints::save(const string& filename) const
+{
+    ofstream ofile{filename};
+    if (!ofile)
+        return false;
+
+    ofile << file_header << "\n"
+          << "schema " << hex << m_schema << "\n";
+
+    for (const book& b : m_books)
+        ofile << b.name << " " << dec << b.first_monad << " " << b.last_monad << " " << hex << b.hash << "\n";
+
+    return ofile.good();
+}
+
+bool book_fingerprints::changed_books(const book_fingerprints& old, vector<size_t>& changed) const
+{
+    changed.clear();
+
+    if (m_schema!=old.m_schema || m_books.size()!=old.m_books.size())
+        return false;
+
+    for (size_t i=0; i<m_books.size(); ++i) {
+        const book& nb = m_books[i];
+        const book& ob = old.m_books[i];
+
+        if (nb.name!=ob.name || nb.first_monad!=ob.first_monad || nb.last_monad!=ob.last_monad)
+            return false;
+
+        if (nb.hash!=ob.hash)
+            changed.push_back(i);
+    }
+
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef _BOOK_FINGERPRINTS_HPP
+#define _BOOK_FINGERPRINTS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Fingerprints of the MQL code generated for each book. By comparing the fingerprints of a new
+// version of the data with those stored when the database was generated, the books that have
+// changed can be identified and updated without rebuilding the entire database.
+class book_fingerprints {
+  public:
+    struct book {
+        std::string name;
+        int first_monad;
+        int last_monad;
+        uint64_t hash;      // FNV-1a hash of the MQL code of the objects of the book
+    };
+
+    // Sets the fingerprint of the MQL code that is common to all books, such as object type
+    // definitions. If this changes, the database must be rebuilt.
+    void set_schema(uint64_t hash) { m_schema = hash; }
+
+    // Adds the fingerprint of a book. Books are added in monad order.
+    void add_book(const std::string& name, int first_monad, int last_monad, uint64_t hash);
+
+    const std::vector<book>& books() const { return m_books; }
+
+    // Reads fingerprints from a file.
+    // Returns:
+    //    False if the file cannot be read or is malformed
+    bool load(const std::string& filename);
+
+    // Writes fingerprints to a file.
+    // Returns:
+    //    False if the file cannot be written
+    bool save(const std::string& filename) const;
+
+    // Finds the books whose fingerprints differ from those in an older set of fingerprints.
+    // Parameters:
+    //    old: The older fingerprints
+    //    changed: Set to the indexes of the changed books
+    // Returns:
+    //    False if the books cannot be updated individually because the common MQL code, the set
+    //    of books, or the monad ranges of the books differ
+    bool changed_books(const book_fingerprints& old, std::vector<size_t>& changed) const;
+
+  private:
+    uint64_t m_schema {0};
+    std::vector<book> m_books;
+};
+
+#endif // _BOOK_FINGERPRINTS_HPP
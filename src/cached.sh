@@ -0,0 +1,112 @@
+#!/bin/sh
+# Copyright © 2023 Claus Tøndering.
+# Released under an MIT License.
+
+# Runs a command that generates output files, using a content-addressed cache.
+#
+# Usage:
+#     cached.sh -i input... -o output... -- command [arguments]
+#
+# The cache key is the SHA-256 hash of the command line and the contents of the input files. The
+# programs that generate the output should themselves be given as inputs, so that a new version
+# of a program invalidates the cache. An input may be a directory, in which case all files in the
+# directory are hashed.
+#
+# If the cache contains outputs for the key, they are copied to their destinations and the command
+# is not run. Otherwise the command is run, and if it succeeds, its outputs are stored in the cache.
+#
+# Arguments that do not affect the outputs, such as a thread count, should not appear on the
+# command line, as they would make the key differ. Pass them in environment variables instead.
+#
+# The cache is kept in $NESTLE1904_CACHE (default: $HOME/.cache/nestle1904).
+# If NESTLE1904_CACHE is "off", the command is always run.
+
+set -e
+
+usage() {
+    echo "Usage: $0 -i input... -o output... -- command [arguments]" >&2
+    exit 1
+}
+
+inputs=""
+outputs=""
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -i) [ $# -ge 2 ] || usage; inputs="$inputs
+$2"; shift 2 ;;
+        -o) [ $# -ge 2 ] || usage; outputs="$outputs
+$2"; shift 2 ;;
+        --) shift; break ;;
+        *)  usage ;;
+    esac
+done
+
+[ $# -gt 0 ] && [ -n "$outputs" ] || usage
+
+cache_dir="${NESTLE1904_CACHE:-$HOME/.cache/nestle1904}"
+
+if [ "$cache_dir" = "off" ]; then
+    exec "$@"
+fi
+
+echo "$inputs" | while IFS= read -r input; do
+    if [ -n "$input" ] && [ ! -e "$input" ]; then
+        echo "$0: Input $input does not exist" >&2
+        exit 1
+    fi
+done
+
+# Hashes a file or all files in a directory
+hash_input() {
+    if [ -d "$1" ]; then
+        (cd "$1" && find . -type f | LC_ALL=C sort | xargs -d '\n' sha256sum)
+    else
+        sha256sum < "$1"
+    fi
+}
+
+key=$(
+    {
+        echo "cached.sh 1"
+        printf '%s\n' "$@"
+        echo "$inputs" | while IFS= read -r input; do
+            [ -n "$input" ] || continue
+            echo "input $input"
+            hash_input "$input"
+        done
+        echo "$outputs"
+    } | sha256sum | cut -d ' ' -f 1
+)
+
+entry="$cache_dir/$key"
+
+if [ -f "$entry/complete" ]; then
+    echo "$0: Restoring$(echo "$outputs" | tr '\n' ' ')from cache" >&2
+    n=0
+    echo "$outputs" | while IFS= read -r output; do
+        [ -n "$output" ] || continue
+        n=$((n+1))
+        rm -f "$output"
+        cp "$entry/$n" "$output"
+    done
+    exit 0
+fi
+
+"$@"
+
+# Store the outputs in a temporary directory which is then renamed, so that a concurrent build
+# never sees a partial cache entry
+mkdir -p "$cache_dir"
+tmp=$(mktemp -d "$cache_dir/tmp.XXXXXX")
+n=0
+echo "$outputs" | while IFS= read -r output; do
+    [ -n "$output" ] || continue
+    n=$((n+1))
+    cp "$output" "$tmp/$n"
+done
+touch "$tmp/complete"
+
+if ! mv -T "$tmp" "$entry" 2>/dev/null; then
+    rm -rf "$tmp" # Another build stored the same entry
+fi
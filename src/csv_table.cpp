@@ -0,0 +1,62 @@
+#include <iostream>
+#include "rapidcsv/src/rapidcsv.h"
+
+#include "csv_table.hpp"
+
+using namespace std;
+
+// See csv_table.hpp for documentation of the functions
+
+
+bool csv_table::load(const string& filename, int monad_col, ostream& err)
+{
+    rapidcsv::Document csv;
+
+    try {
+        csv.Load(filename);
+    }
+    catch (const ios_base::failure& e) {
+        err << e.what() << "\n";
+        err << "Cannot open " << filename << "\n";
+        return false;
+    }
+
+    size_t row_count = csv.GetRowCount();
+    m_rows.clear();
+    m_rows.reserve(row_count);
+    m_row_of_monad.clear();
+
+    for (size_t rix=0; rix<row_count; ++rix) {
+        m_rows.push_back(csv.GetRow<string>(rix));
+        const row_t& row = m_rows.back();
+
+        int monad;
+        try {
+            monad = size_t(monad_col)<row.size() ? stoi(row[monad_col]) : -1;
+        }
+        catch (const logic_error&) {
+            monad = -1;
+        }
+
+        if (monad<0) {
+            err << filename << ": Invalid monad number in row " << rix+2 << "\n";
+            return false;
+        }
+
+        if (size_t(monad)>=m_row_of_monad.size())
+            m_row_of_monad.resize(monad+1, -1);
+
+        if (m_row_of_monad[monad]==-1)
+            m_row_of_monad[monad] = rix;
+    }
+
+    return true;
+}
+
+csv_table::row_t* csv_table::find(int monad)
+{
+    if (monad<0 || size_t(monad)>=m_row_of_monad.size() || m_row_of_monad[monad]==-1)
+        return nullptr;
+
+    return &m_rows[m_row_of_monad[monad]];
+}
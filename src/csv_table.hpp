@@ -0,0 +1,38 @@
+#ifndef _CSV_TABLE_HPP
+#define _CSV_TABLE_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// The rows of a CSV file indexed by the monad number found in one of the columns.
+// The file is read once, after which rows can be looked up by monad in any order.
+class csv_table {
+  public:
+    using row_t = std::vector<std::string>;
+
+    // Reads a CSV file. The first line of the file contains the column headers.
+    // Parameters:
+    //    filename: The name of the CSV file
+    //    monad_col: The column that holds the monad number of each row
+    //    err: Error messages are written to this stream
+    // Returns:
+    //    False if the file cannot be read or contains an invalid monad number. A message has
+    //    been written to err.
+    bool load(const std::string& filename, int monad_col, std::ostream& err);
+
+    // Finds the row with the specified monad. If several rows have the same monad, the first one
+    // is used.
+    // Returns:
+    //    The row, or nullptr if there is no row with the specified monad
+    row_t* find(int monad);
+
+    // Retrieves the number of rows in the table
+    size_t size() const { return m_rows.size(); }
+
+  private:
+    std::vector<row_t> m_rows;
+    std::vector<int> m_row_of_monad;  // monad => index in m_rows, or -1
+};
+
+#endif // _CSV_TABLE_HPP
@@ -2,61 +2,27 @@
  * Released under an MIT License.
  */
  
+#include <algorithm>
+#include <iostream>
 #include "emdros_iterators.hpp"
 
+using namespace std;
+
 StrawOk::const_iterator::const_iterator(StrawConstIterator se)
     : m_se{se}
 {
     operator++();
 }
 
-StrawOk::const_iterator::const_iterator()
-    : m_end{true}
-{
-}
-
-bool StrawOk::const_iterator::operator!=(const const_iterator& rhs)
-{
-    return m_end!=rhs.m_end;
-}
-
 StrawOk::const_iterator& StrawOk::const_iterator::operator++()
 {
-    if (m_se.hasNext()) {
-        m_end = false;
-        m_mo = m_se.next();
-    }
-    else
-        m_end = true;
-
+    m_mo = m_se.hasNext() ? m_se.next() : nullptr;
     return *this;
 }
 
-
-const MatchedObject StrawOk::const_iterator::operator*()
-{
-    return *m_mo;
-}
-
-
-StrawOk::StrawOk(const Straw* stp)
-    : m_stp{stp}
-{
-}
-
-StrawOk::StrawOk()
-    : m_stp{0}
-{
-}
-
 StrawOk::const_iterator StrawOk::begin() const
 {
-    return const_iterator{m_stp->const_iterator()};
-}
-
-StrawOk::const_iterator StrawOk::end() const
-{
-    return const_iterator{};
+    return m_stp ? const_iterator{m_stp->const_iterator()} : const_iterator{};
 }
 
 
@@ -66,45 +32,96 @@ SheafOk::const_iterator::const_iterator(SheafConstIterator se)
     operator++();
 }
 
-SheafOk::const_iterator::const_iterator()
-    : m_end{true}
+SheafOk::const_iterator& SheafOk::const_iterator::operator++()
 {
+    m_str = m_se.hasNext() ? m_se.next() : nullptr;
+    return *this;
 }
 
-bool SheafOk::const_iterator::operator!=(const const_iterator& rhs)
+SheafOk::const_iterator SheafOk::begin() const
 {
-    return m_end!=rhs.m_end;
+    return const_iterator{m_shp->const_iterator()};
 }
 
-SheafOk::const_iterator& SheafOk::const_iterator::operator++()
+
+// Executes an MQL query. Errors are not printed by Emdros but written to err, so that the caller
+// decides where they go.
+// Parameters:
+//    env: The Emdros environment
+//    err: Error messages are written to this stream
+//    mql_request: The query
+// Returns:
+//    False if the query failed
+static bool execute(EmdrosEnv& env, ostream& err, const string& mql_request)
 {
-    if (m_se.hasNext()) {
-        m_end = false;
-        m_str = StrawOk{m_se.next()};
+    bool bResult{false};
+    if (!env.executeString(mql_request, bResult, false, false) || !bResult) {
+        err << "ERROR: Query failed: " << mql_request << '\n'
+            << env.getCompilerError() << env.getDBError() << '\n';
+        return false;
     }
-    else
-        m_end = true;
 
-    return *this;
+    return true;
 }
 
-const StrawOk SheafOk::const_iterator::operator*()
+// Executes a query that returns a single monad, such as "SELECT MIN_M GO"
+// Parameters:
+//    env: The Emdros environment
+//    err: Error messages are written to this stream
+//    mql_request: The query
+//    monad: Set to the monad returned by the query
+// Returns:
+//    False if the query failed
+static bool select_monad(EmdrosEnv& env, ostream& err, const string& mql_request, int& monad)
 {
-    return m_str;
-}
+    if (!execute(env, err, mql_request))
+        return false;
 
+    if (!env.isTable()) {
+        err << "ERROR: Result of " << mql_request << " is not table\n";
+        return false;
+    }
 
-SheafOk::SheafOk(const Sheaf* shp)
-    : m_shp{shp}
-{
+    Table *table = env.getTable();
+    TableIterator ti = table->iterator();
+    if (!ti.hasNext()) {
+        err << "ERROR: Result of " << mql_request << " is empty\n";
+        return false;
+    }
+
+    monad = stoi(table->getColumn(ti, 1));
+    return true;
 }
 
-SheafOk::const_iterator SheafOk::begin() const
+bool monad_range(EmdrosEnv& env, ostream& err, int& first_monad, int& last_monad)
 {
-    return const_iterator{m_shp->const_iterator()};
+    return select_monad(env, err, "SELECT MIN_M GO", first_monad)
+        && select_monad(env, err, "SELECT MAX_M GO", last_monad);
 }
 
-SheafOk::const_iterator SheafOk::end() const
+
+bool select_in_batches(EmdrosEnv& env, ostream& err, const string& topograph,
+                       int first_monad, int last_monad, int batch_size,
+                       const function<bool(StrawOk)>& f)
 {
-    return const_iterator{};
+    for (int from=first_monad; from<=last_monad; from+=batch_size) {
+        int to = min(last_monad, from+batch_size-1);
+
+        string mql_request{"SELECT ALL OBJECTS IN { " + to_string(from) + "-" + to_string(to) + " } "
+                           "WHERE " + topograph + " GO"};
+
+        if (!execute(env, err, mql_request))
+            return false;
+
+        if (!env.isSheaf()) {
+            err << "ERROR: Result is not sheaf\n";
+            return false;
+        }
+
+        for (StrawOk str : SheafOk{env.getSheaf()})
+            if (!f(str))
+                return false;
+    }
+
+    return true;
 }
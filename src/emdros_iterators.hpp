@@ -5,58 +5,132 @@
 #ifndef _EMDROS_ITERATORS_HPP
 #define _EMDROS_ITERATORS_HPP
 
+#include <cstddef>
+#include <functional>
 #include <iterator>
+#include <ostream>
+#include <string>
+#include <emdros/emdros_environment.h>
 #include <emdros/mql_sheaf.h>
+#include <emdros/table.h>
 
+// Ranges over the contents of Emdros sheaves. The iterators refer to the objects in the sheaf
+// without copying them, so the sheaf must exist for as long as the iterators are used.
+// Both classes are C++20 input ranges whose end is std::default_sentinel.
 
+
+// A view of the matched objects in a straw
 class StrawOk {
-    class const_iterator : public std::iterator<std::input_iterator_tag, Straw> {
+  public:
+    class const_iterator {
       public:
-        const_iterator(StrawConstIterator se);
-        const_iterator(); // Creates an end iterator
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = MatchedObject;
+        using difference_type = std::ptrdiff_t;
+        using reference = const MatchedObject&;
+        using pointer = const MatchedObject*;
+
+        const_iterator() = default;
+        explicit const_iterator(StrawConstIterator se);
 
-        bool operator!=(const const_iterator& rhs);
+        reference operator*() const { return *m_mo; }
+        pointer operator->() const { return m_mo; }
         const_iterator& operator++();
-        const MatchedObject operator*();
+        void operator++(int) { ++*this; }
+
+        bool operator==(std::default_sentinel_t) const { return m_mo==nullptr; }
 
       private:
-        bool m_end;
         StrawConstIterator m_se;
-        const MatchedObject *m_mo;
+        const MatchedObject *m_mo{nullptr};  // Current object, or nullptr at the end
     };
 
-  public:
-    StrawOk(const Straw* stp);
-    StrawOk();
+    StrawOk(const Straw* stp = nullptr) : m_stp{stp} {}
     const_iterator begin() const;
-    const_iterator end() const;
+    std::default_sentinel_t end() const { return {}; }
+
   private:
     const Straw *m_stp;
 };
 
 
+// A view of the straws in a sheaf. The straws are returned as StrawOk views.
 class SheafOk {
-    class const_iterator : public std::iterator<std::input_iterator_tag, StrawOk> {
+  public:
+    class const_iterator {
       public:
-        const_iterator(SheafConstIterator se);
-        const_iterator(); // Creates an end iterator
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = StrawOk;
+        using difference_type = std::ptrdiff_t;
+        using reference = StrawOk;
 
-        bool operator!=(const const_iterator& rhs);
+        const_iterator() = default;
+        explicit const_iterator(SheafConstIterator se);
+
+        reference operator*() const { return StrawOk{m_str}; }
         const_iterator& operator++();
-        const StrawOk operator*();
+        void operator++(int) { ++*this; }
+
+        bool operator==(std::default_sentinel_t) const { return m_str==nullptr; }
 
       private:
-        bool m_end;
         SheafConstIterator m_se;
-        StrawOk m_str;
+        const Straw *m_str{nullptr};  // Current straw, or nullptr at the end
     };
 
-  public:
-    SheafOk(const Sheaf* shp);
+    SheafOk(const Sheaf* shp) : m_shp{shp} {}
     const_iterator begin() const;
-    const_iterator end() const;
+    std::default_sentinel_t end() const { return {}; }
+
   private:
     const Sheaf *m_shp;
 };
 
+
+// Typed access to the features of a matched object. A feature is identified by its position in the
+// GET clause of the query.
+
+// Retrieves an integer or id_d feature
+inline long feature_long(const MatchedObject& mo, int ix)
+{
+    return mo.getFeatureAsLong(ix);
+}
+
+// Retrieves an enumeration feature as a value of the C++ enumeration T. This requires the values
+// of the Emdros enumeration constants to be those of T, which is the case for enumerations
+// created by morph_info<T>::create_enum(). No string is created.
+template <typename T>
+T feature_enum(const MatchedObject& mo, int ix)
+{
+    return static_cast<T>(mo.getFeatureAsLong(ix));
+}
+
+
+// Retrieves the range of monads used in the database.
+// Parameters:
+//    env: The Emdros environment
+//    err: Error messages are written to this stream
+//    first_monad: Set to the lowest monad in the database
+//    last_monad: Set to the highest monad in the database
+// Returns:
+//    False if a query failed
+bool monad_range(EmdrosEnv& env, std::ostream& err, int& first_monad, int& last_monad);
+
+// Executes an MQL SELECT ALL OBJECTS query in consecutive ranges of monads and passes the straws of
+// the resulting sheaves to a function. Only the sheaf of one range exists at a time. Objects that
+// span more than one range are not found, so the query should look for single-monad objects, such
+// as words.
+// Parameters:
+//    env: The Emdros environment
+//    err: Error messages, including those from Emdros, are written to this stream
+//    topograph: The query without SELECT and GO, for example "[word psp=noun GET self]"
+//    first_monad, last_monad: The monads to search
+//    batch_size: The number of monads in each range
+//    f: Function called for each straw. If it returns false, the search stops
+// Returns:
+//    False if a query failed or f returned false
+bool select_in_batches(EmdrosEnv& env, std::ostream& err, const std::string& topograph,
+                       int first_monad, int last_monad, int batch_size,
+                       const std::function<bool(StrawOk)>& f);
+
 #endif // _EMDROS_ITERATORS_HPP
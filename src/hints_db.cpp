@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <iostream>
+#include <sqlite3.h>
+
+#include "hints_db.hpp"
+
+using namespace std;
+
+// See hints_db.hpp for documentation of the functions
+
+
+// Executes SQL statements that return no data.
+// Returns:
+//     False if an error occurred. A message has been written to cerr.
+
+static bool execute(sqlite3 *db, const char *sql)
+{
+    char *errmsg;
+
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &errmsg)!=SQLITE_OK) {
+        cerr << "SQLite error: " << errmsg << "\n";
+        sqlite3_free(errmsg);
+        return false;
+    }
+
+    return true;
+}
+
+static bool insert_hints(sqlite3 *db, const vector<hint>& hints)
+{
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, "INSERT INTO hints VALUES(?,?)", -1, &stmt, nullptr)!=SQLITE_OK) {
+        cerr << "SQLite error: " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+
+    for (const hint& h : hints) {
+        sqlite3_bind_int64(stmt, 1, h.self);
+        sqlite3_bind_text(stmt, 2, h.text.data(), h.text.size(), SQLITE_STATIC);
+
+        if (sqlite3_step(stmt)!=SQLITE_DONE) {
+            cerr << "SQLite error: " << sqlite3_errmsg(db) << " (self=" << h.self << ")\n";
+            sqlite3_finalize(stmt);
+            return false;
+        }
+
+        sqlite3_reset(stmt);
+    }
+
+    sqlite3_finalize(stmt);
+    return true;
+}
+
+bool write_hints_db(const string& filename, const vector<hint>& hints)
+{
+    remove(filename.c_str());
+
+    sqlite3 *db;
+
+    if (sqlite3_open(filename.c_str(), &db)!=SQLITE_OK) {
+        cerr << "Cannot open " << filename << ": " << sqlite3_errmsg(db) << "\n";
+        sqlite3_close(db);
+        return false;
+    }
+
+    // The database is discarded if the program fails, so there is no need for a journal
+    bool ok = execute(db,
+                      "PRAGMA journal_mode=OFF;"
+                      "PRAGMA synchronous=OFF;"
+                      "CREATE TABLE hints (self integer primary key, hint text);"
+                      "BEGIN TRANSACTION;")
+        && insert_hints(db, hints)
+        && execute(db,
+                   "COMMIT;"
+                   "ANALYZE;"
+                   "VACUUM;");
+
+    sqlite3_close(db);
+
+    if (!ok)
+        remove(filename.c_str());
+
+    return ok;
+}
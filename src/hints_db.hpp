@@ -0,0 +1,23 @@
+#ifndef _HINTS_DB_HPP
+#define _HINTS_DB_HPP
+
+#include <string>
+#include <vector>
+
+// A hint that helps the user identify the intended interpretation of an ambiguous word
+struct hint {
+    long self;          // Emdros id_d of the word
+    std::string text;   // The hint, for example "gender≠masculine"
+};
+
+// Creates the hints database, which contains the table
+//     hints (self integer primary key, hint text)
+// An existing file with the same name is replaced.
+// Parameters:
+//    filename: The name of the SQLite database file
+//    hints: The hints to store
+// Returns:
+//    False if the database could not be written. A message has been written to cerr.
+bool write_hints_db(const std::string& filename, const std::vector<hint>& hints);
+
+#endif // _HINTS_DB_HPP
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+
+#include "hints_store.hpp"
+#include "util.hpp"
+
+using namespace std;
+
+// See hints_store.hpp for documentation of the functions
+
+
+hints_store::hints_store(const string& filename)
+    : m_file{filename, mapped_file::access::normal}, // Read once for the checksum, then searched randomly
+      m_entries{nullptr}, m_texts{nullptr}, m_strings{nullptr}, m_count{0}
+{
+    if (!m_file.is_open()) {
+        m_error = "Cannot open " + filename;
+        return;
+    }
+
+    if (m_file.size()<sizeof(header)) {
+        m_error = filename + " is too short";
+        return;
+    }
+
+    header h;
+    memcpy(&h, m_file.data(), sizeof(header));
+
+    if (memcmp(h.magic, magic, sizeof(magic))!=0) {
+        m_error = filename + " is not a hints file";
+        return;
+    }
+
+    if (h.version!=version) {
+        m_error = filename + " has unsupported version " + to_string(h.version);
+        return;
+    }
+
+    if (m_file.size() != sizeof(header) + h.count*sizeof(entry) + h.text_count*sizeof(text) + h.strings_size) {
+        m_error = filename + " has wrong size";
+        return;
+    }
+
+    string_view body = m_file.view().substr(sizeof(header));
+    if (fnv1a(body)!=h.checksum) {
+        m_error = filename + " has wrong checksum";
+        return;
+    }
+
+    const entry *entries = reinterpret_cast<const entry*>(m_file.data() + sizeof(header));
+    const text *texts = reinterpret_cast<const text*>(entries + h.count);
+
+    for (size_t i=0; i<h.text_count; ++i) {
+        if (texts[i].pos + uint64_t{texts[i].len} > h.strings_size) {
+            m_error = filename + " has a string outside the string table";
+            return;
+        }
+    }
+
+    for (size_t i=0; i<h.count; ++i) {
+        if (entries[i].text_id>=h.text_count || (i>0 && entries[i-1].self>=entries[i].self)) {
+            m_error = filename + " has an invalid entry";
+            return;
+        }
+    }
+
+    m_entries = entries;
+    m_texts = texts;
+    m_strings = reinterpret_cast<const char*>(texts + h.text_count);
+    m_count = h.count;
+}
+
+bool hints_store::write(const string& filename, const vector<hint>& hints)
+{
+    vector<entry> entries;
+    vector<text> texts;
+    string strings;
+    unordered_map<string_view, uint32_t> text_ids; // Hint string => index in texts
+
+    entries.reserve(hints.size());
+
+    for (const hint& h : hints) {
+        if (h.self<0 || h.self>numeric_limits<uint32_t>::max()) {
+            cerr << "Cannot store id_d " << h.self << " in " << filename << "\n";
+            return false;
+        }
+
+        auto [it, inserted] = text_ids.emplace(h.text, texts.size());
+        if (inserted) {
+            texts.push_back({uint32_t(strings.size()), uint32_t(h.text.size())});
+            strings.append(h.text);
+        }
+
+        entries.push_back({uint32_t(h.self), it->second});
+    }
+
+    sort(entries.begin(), entries.end(), [](const entry& a, const entry& b) { return a.self<b.self; });
+
+    auto dup = adjacent_find(entries.begin(), entries.end(), [](const entry& a, const entry& b) { return a.self==b.self; });
+    if (dup!=entries.end()) {
+        cerr << "More than one hint for id_d " << dup->self << "\n";
+        return false;
+    }
+
+    string_view entry_bytes{reinterpret_cast<const char*>(entries.data()), entries.size()*sizeof(entry)};
+    string_view text_bytes{reinterpret_cast<const char*>(texts.data()), texts.size()*sizeof(text)};
+
+    header h;
+    memcpy(h.magic, magic, sizeof(magic));
+    h.version = version;
+    h.count = entries.size();
+    h.text_count = texts.size();
+    h.reserved = 0;
+    h.strings_size = strings.size();
+    h.checksum = fnv1a(strings, fnv1a(text_bytes, fnv1a(entry_bytes)));
+
+    ofstream ofile{filename, ios::binary};
+    if (!ofile) {
+        cerr << "Cannot open " << filename << "\n";
+        return false;
+    }
+
+    ofile.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    ofile.write(entry_bytes.data(), entry_bytes.size());
+    ofile.write(text_bytes.data(), text_bytes.size());
+    ofile.write(strings.data(), strings.size());
+
+    if (!ofile) {
+        cerr << "Cannot write " << filename << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+string_view hints_store::find(long self) const
+{
+    if (self<0 || self>numeric_limits<uint32_t>::max())
+        return {};
+
+    const entry *end = m_entries + m_count;
+    const entry *e = lower_bound(m_entries, end, uint32_t(self),
+                                 [](const entry& e, uint32_t s) { return e.self<s; });
+
+    if (e==end || e->self!=self)
+        return {};
+
+    return get_text(e->text_id);
+}
@@ -0,0 +1,88 @@
+#ifndef _HINTS_STORE_HPP
+#define _HINTS_STORE_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "hints_db.hpp"
+#include "mapped_file.hpp"
+
+// A binary file containing the same hints as the hints database. The file is memory-mapped, and
+// the hint of a word is found by binary search, so no database connection is needed.
+// Only a few hundred different hint strings exist, so each string is stored once and the words
+// refer to it by number.
+//
+// File layout (all integers in native byte order):
+//     header
+//     entry[count], sorted by self
+//     text[text_count]
+//     string table of strings_size bytes holding the hint strings
+// The checksum in the header is the FNV-1a hash of everything following the header.
+class hints_store {
+  public:
+    static constexpr char magic[8] = {'H','I','N','T','S','T','R','\0'};
+    static constexpr uint32_t version = 1;
+
+    struct header {
+        char magic[8];
+        uint32_t version;
+        uint32_t count;         // Number of entries
+        uint32_t text_count;    // Number of different hint strings
+        uint32_t reserved;
+        uint64_t strings_size;  // Size of string table
+        uint64_t checksum;
+    };
+
+    struct entry {
+        uint32_t self;          // Emdros id_d of the word
+        uint32_t text_id;       // Index of the hint string in the text array
+    };
+
+    struct text {
+        uint32_t pos;           // Position of the hint string in the string table
+        uint32_t len;
+    };
+
+    // Constructor. Maps and validates a hints file. Use is_open() to check for success.
+    // Parameter:
+    //    filename: Name of the hints file
+    hints_store(const std::string& filename);
+
+    // Returns true if the file was successfully mapped and validated
+    bool is_open() const { return m_entries!=nullptr; }
+
+    // Retrieves a description of the problem if is_open() returns false
+    const std::string& error() const { return m_error; }
+
+    // Writes a hints file.
+    // Parameters:
+    //    filename: Name of the hints file
+    //    hints: The hints in any order. Each word may have only one hint
+    // Returns:
+    //    False if the file could not be written. A message has been written to cerr.
+    static bool write(const std::string& filename, const std::vector<hint>& hints);
+
+    // Retrieves the number of words that have a hint
+    size_t size() const { return m_count; }
+
+    // Finds the hint of a word.
+    // Parameter:
+    //    self: The Emdros id_d of the word
+    // Returns:
+    //    The hint, or an empty string if the word has no hint
+    std::string_view find(long self) const;
+
+  private:
+    std::string_view get_text(uint32_t id) const { return {m_strings+m_texts[id].pos, m_texts[id].len}; }
+
+    mapped_file m_file;
+    const entry *m_entries;
+    const text *m_texts;
+    const char *m_strings;
+    size_t m_count;
+    std::string m_error;
+};
+
+#endif // _HINTS_STORE_HPP
@@ -6,13 +6,25 @@
 #include <emdros/emdros_environment.h>
 #include <emdros/mql_sheaf.h>
 #include <emdros/emdf_value.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
 #include <iostream>
-#include <fstream>
+#include <limits>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
-#include "rapidcsv/src/rapidcsv.h"
 
+#include "csv_table.hpp"
 #include "emdros_iterators.hpp"
+#include "hints_db.hpp"
+#include "hints_store.hpp"
+#include "morph.hpp"
 #include "util.hpp"
 
 using namespace std;
@@ -35,7 +47,7 @@ enum class cols_verbs {
 
 string& at(vector<string>& r, int c)
 {
-    static string unknown = "unknown";
+    thread_local string unknown = "unknown"; // Modifiable by the caller, so one per pass thread
     
     if (c >= r.size())
         return unknown;
@@ -110,302 +122,244 @@ vector<vector<int>> verb_feat_diffs{
 vector<string> verb_feat_diff2string { "number", "person", "tense", /*"voice",*/ "mood" };
     
 
-class selector {
+// Translates the values of a feature into small integer codes, so that feature values can be
+// compared as integers. When the codec is created from a morphology enumeration, the strings of
+// the enumeration are coded as their enumeration values. Other strings, such as "" and "unknown",
+// are given new codes when they are first met.
+class feature_codec {
   public:
-    selector(const vector<vector<int>>& feat_diffs, const vector<string>& feat_diff2string, const initializer_list<int> two, const initializer_list<int> three)
-        : m_feat_diffs{feat_diffs},
-          m_feat_diff2string{feat_diff2string},
-          m_twovalues{two},
-          m_threevalues{three}
-        {}
-            
-
-    string diff2(const vector<string>&r) {
-        for (int i=0; i<m_feat_diffs[0].size(); ++i) {
-            int col0 = m_feat_diffs[0][i];
-            int col1 = m_feat_diffs[1][i];
-
-            if (at(r,col0)!=at(r,col1)) {
-                if (m_twovalues.contains(i))
-                    return m_feat_diff2string.at(i) + "=" + at(r,col0);// + "---21a";
-                else
-                    return m_feat_diff2string.at(i) + "≠" + at(r,col1);// + "---21b";
-            }
+    using code_t = uint8_t;
+
+    feature_codec() = default;
+
+    template <typename T>
+    static feature_codec from_enum() {
+        feature_codec fc;
+        for (const auto& [t, s] : morph_info<T>::all_strings()) {
+            code_t c = fc.encode(s);
+            assert(c==static_cast<code_t>(t));
         }
-        for (auto rc : r)
-            cerr << rc << " ";
-        cerr << "INDETERMINATE 1\n";
-        return "INDETERMINATE 1";
+        return fc;
     }
 
-    string diff3(const vector<string>&r) {
-        // Look for single ≠ selector
-        
-        for (int i=0; i<m_feat_diffs[0].size(); ++i) {
-            int col0 = m_feat_diffs[0][i];
-            int col1 = m_feat_diffs[1][i];
-            int col2 = m_feat_diffs[2][i];
-
-            if (at(r,col0)!=at(r,col1) && at(r,col1)==at(r,col2))
-                if (m_twovalues.contains(i))
-                    return m_feat_diff2string.at(i) + "=" + at(r,col0);// + "---31a";
-                else
-                    return m_feat_diff2string.at(i) + "≠" + at(r,col1);// + "---31b";
+    code_t encode(const string& s) {
+        auto it = m_codes.find(s);
+        if (it!=m_codes.end())
+            return it->second;
+
+        if (m_values.size()>numeric_limits<code_t>::max()) {
+            cerr << "Too many different feature values\n";
+            exit(1);
         }
 
-        // Look for double ≠ selector
-        for (int i=0; i<m_feat_diffs[0].size(); ++i) {
-            int col0 = m_feat_diffs[0][i];
-            int col1 = m_feat_diffs[1][i];
-            int col2 = m_feat_diffs[2][i];
+        code_t c = m_values.size();
+        m_values.push_back(s);
+        m_codes.emplace(s, c);
+        return c;
+    }
 
-            if (at(r,col0)!=at(r,col1) && at(r,col0)!=at(r,col2))
-                if (m_threevalues.contains(i))
-                    return m_feat_diff2string.at(i) + "=" + at(r,col0);// + "---32a";
-                else
-                    return m_feat_diff2string.at(i) + "≠" + at(r,col1) + "," + m_feat_diff2string.at(i) + "≠" + at(r,col2);// + "---32b";
-        }
+    const string& decode(code_t c) const {
+        return m_values[c];
+    }
 
-        // Look for selector involving two features
-        // (This is tailored to find {feminine nominative, feminine genitive, masculine nominative}
-        // triplets as this is the only relevant case in Nestle1904)
-        if (at(r,m_feat_diffs[0][0])=="feminine"  && at(r,m_feat_diffs[0][1])=="singular" && at(r,m_feat_diffs[0][2])=="nominative" &&
-            at(r,m_feat_diffs[1][0])=="feminine"  && at(r,m_feat_diffs[1][1])=="singular" && at(r,m_feat_diffs[1][2])=="genitive" &&
-            at(r,m_feat_diffs[2][0])=="masculine" && at(r,m_feat_diffs[2][1])=="singular" && at(r,m_feat_diffs[2][2])=="nominative")
-            return m_feat_diff2string.at(0) + "≠masculine," + m_feat_diff2string.at(2) + "≠genitive";
-        
-        for (auto rc : r)
-            cerr << rc << " ";
-        cerr << "INDETERMINATE 2\n";
-        return "INDETERMINATE 2";
+  private:
+    vector<string> m_values;                  // code => string
+    unordered_map<string, code_t> m_codes;    // string => code
+};
+
+
+// The coded values of the features of one alternative interpretation of a word, packed into a
+// single integer with one byte per feature
+class feature_vector {
+  public:
+    static constexpr int max_features = 4;
+
+    feature_codec::code_t operator[](int i) const {
+        return m_packed >> (8*i);
     }
 
-    string diff4(const vector<string>&r) {
-        // Look for single ≠ selector
-        for (int i=0; i<m_feat_diffs[0].size(); ++i) {
-            string s0 = at(r, m_feat_diffs[0][i]);
-            string s1 = at(r, m_feat_diffs[1][i]);
-            string s2 = at(r, m_feat_diffs[2][i]);
-            string s3 = at(r, m_feat_diffs[3][i]);
-            
-            if (s0!=s1 && s1==s2 && s1==s3)
-                return m_feat_diff2string.at(i) + "≠" + s1;// + "---41";
-        }
+    void set(int i, feature_codec::code_t c) {
+        m_packed |= uint32_t(c) << (8*i);
+    }
 
-        // Look for double ≠ selector
-        for (int i=0; i<m_feat_diffs[0].size(); ++i) {
-            string s0 = at(r, m_feat_diffs[0][i]);
-            string s1 = at(r, m_feat_diffs[1][i]);
-            string s2 = at(r, m_feat_diffs[2][i]);
-            string s3 = at(r, m_feat_diffs[3][i]);
-
-            if (s0==s1 || s0==s2 || s0==s3)
-                continue;
-
-            string sA, sB;
-            
-            if (s1==s2) {
-                sA = s1;
-                sB = s3;
-            }
-            else if (s1==s3) {
-                sA = s1;
-                sB = s2;
-            }
-            else if (s2==s3) {
-                sA = s2;
-                sB = s1;
-            }
-            else
-                continue;
+    // Checks if two vectors have the same values for the features in a mask
+    bool same(const feature_vector& other, uint32_t mask) const {
+        return ((m_packed ^ other.m_packed) & mask) == 0;
+    }
 
-            return m_feat_diff2string.at(i) + "≠" + sA + "," + m_feat_diff2string.at(i) + "≠" + sB;// + "---42";
-        }
+    // Retrieves the mask that selects feature i
+    static uint32_t mask(int i) {
+        return uint32_t{0xff} << (8*i);
+    }
+
+  private:
+    uint32_t m_packed{0};
+};
 
-//        // Look for single = selector
-//        for (int i=0; i<m_feat_diffs[0].size(); ++i) {
-//            string s0 = at(r, m_feat_diffs[0][i]);
-//            string s1 = at(r, m_feat_diffs[1][i]);
-//            string s2 = at(r, m_feat_diffs[2][i]);
-//            string s3 = at(r, m_feat_diffs[3][i]);
-//            
-//            if (s0!=s1 && s0!=s2 && s0!=s3 && s1!=s2 && s1!=s3 && s2!=s3)
-//                return m_feat_diff2string.at(i) + "=" + s0 + "---43";
-//        }
 
-        // Indeterminate based on one feature, let's try two features
-        for (int i=0; i<m_feat_diffs[0].size(); ++i) {
-            for (int j=i+1; j<m_feat_diffs[0].size(); ++j) {
-            
-                string s0a = at(r, m_feat_diffs[0][i]);
-                string s1a = at(r, m_feat_diffs[1][i]);
-                string s2a = at(r, m_feat_diffs[2][i]);
-                string s3a = at(r, m_feat_diffs[3][i]);
-                string s0b = at(r, m_feat_diffs[0][j]);
-                string s1b = at(r, m_feat_diffs[1][j]);
-                string s2b = at(r, m_feat_diffs[2][j]);
-                string s3b = at(r, m_feat_diffs[3][j]);
-
-                string s0 = s0a + "." + s0b;
-                string s1 = s1a + "." + s1b;
-                string s2 = s2a + "." + s2b;
-                string s3 = s3a + "." + s3b;
-
-                if (alldiff(s0,s1,s2,s3))
-                    return m_feat_diff2string.at(i) + "=" + s0a + ","
-                        + m_feat_diff2string.at(j) + "=" + s0b;// + "---44";
-            }
+class selector {
+  public:
+    // Constructor.
+    // Parameters:
+    //    feat_diffs: The spreadsheet columns that hold the features of each alternative
+    //    feat_diff2string: The name of each feature
+    //    codecs: The codec for each feature
+    //    two: The features for which the hint names the value of the first alternative rather than
+    //         the rejected value when there are no more than three alternatives
+    //    three: The features for which the hint names the value of the first alternative rather
+    //         than the two rejected values when there are three alternatives
+    selector(const vector<vector<int>>& feat_diffs, const vector<string>& feat_diff2string,
+             vector<feature_codec>&& codecs, const initializer_list<int> two, const initializer_list<int> three)
+        : m_feat_diffs{feat_diffs},
+          m_feat_diff2string{feat_diff2string},
+          m_codecs{std::move(codecs)},
+          m_twovalues{0},
+          m_threevalues{0}
+        {
+            assert(m_codecs.size()==m_feat_diff2string.size() && m_codecs.size()<=feature_vector::max_features);
+            for (int i : two)
+                m_twovalues |= 1<<i;
+            for (int i : three)
+                m_threevalues |= 1<<i;
         }
 
-        for (auto rc : r)
-            cerr << rc << " ";
-        cerr << "INDETERMINATE 3\n";
-        return "INDETERMINATE 3";
+    // Encodes the features of the first count alternatives in a spreadsheet row
+    vector<feature_vector> encode(const vector<string>& r, int count) {
+        vector<feature_vector> alts(count);
+
+        for (int k=0; k<count; ++k)
+            for (size_t i=0; i<m_codecs.size(); ++i)
+                alts[k].set(i, m_codecs[i].encode(at(r, m_feat_diffs[k][i])));
+
+        return alts;
     }
 
-    string diff5(const vector<string>&r) {
+    // Finds a hint that distinguishes the first alternative from the others.
+    // Parameters:
+    //    alts: The alternatives. There must be at least two
+    //    hint: Set to the hint, or to "INDETERMINATE n" if no hint is found
+    // Returns:
+    //    True if a hint was found
+    bool select(const vector<feature_vector>& alts, string& hint) const {
+        int n = alts.size();
+        int nfeat = m_codecs.size();
+
         // Look for single ≠ selector
-        for (int i=0; i<m_feat_diffs[0].size(); ++i) {
-            string s0 = at(r, m_feat_diffs[0][i]);
-            string s1 = at(r, m_feat_diffs[1][i]);
-            string s2 = at(r, m_feat_diffs[2][i]);
-            string s3 = at(r, m_feat_diffs[3][i]);
-            string s4 = at(r, m_feat_diffs[4][i]);
-            
-            if (s0!=s1 && s1==s2 && s1==s3 && s1==s4)
-                return m_feat_diff2string.at(i) + "≠" + s1;// + "---51";
+        for (int i=0; i<nfeat; ++i) {
+            feature_codec::code_t v0 = alts[0][i];
+            feature_codec::code_t v1 = alts[1][i];
+
+            if (v0!=v1 && all_of(alts.begin()+2, alts.end(), [i,v1](const feature_vector& a) { return a[i]==v1; })) {
+                if (n<=3 && (m_twovalues & 1<<i))
+                    hint = equal(i, v0);
+                else
+                    hint = not_equal(i, v1);
+                return true;
+            }
         }
 
-        // Look for double ≠ selector
-//        for (int i=0; i<m_feat_diffs[0].size(); ++i) {
-//            string s0 = at(r, m_feat_diffs[0][i]);
-//            string s1 = at(r, m_feat_diffs[1][i]);
-//            string s2 = at(r, m_feat_diffs[2][i]);
-//            string s3 = at(r, m_feat_diffs[3][i]);
-//            string s4 = at(r, m_feat_diffs[4][i]);
-// 
-//            if (s0==s1 || s0==s2 || s0==s3 || s0==s4)
-//                continue;
-// 
-//            string sA, sB;
-// 
-//            if      (s1==s2 && s3==s4) { sA=s1; sB=s3; } // aabb
-//            else if (s1==s3 && s2==s4) { sA=s1; sB=s2; } // abab
-//            else if (s1==s4 && s2==s3) { sA=s1; sB=s2; } // abba
-// 
-//            else if (s1==s2 && s1==s3) { sA=s1; sB=s4; } // aaab
-//            else if (s1==s2 && s1==s4) { sA=s1; sB=s3; } // aaba
-//            else if (s1==s3 && s1==s4) { sA=s1; sB=s2; } // abaa
-// 
-//            else if (s2==s3 && s2==s4) { sA=s1; sB=s2; } // abbb
-//                
-//            return m_feat_diff2string.at(i) + "≠" + sA + "," + m_feat_diff2string.at(i) + "≠" + sB + "---52";
-//        }
+        // Look for double ≠ selector, where the other alternatives have two values for a feature
+        if (n<=4) {
+            for (int i=0; i<nfeat; ++i) {
+                feature_codec::code_t v0 = alts[0][i];
+                feature_codec::code_t vA = 0, vB = 0; // The other values in order of first occurrence
+                int nA = 0, nB = 0;                   // Multiplicity of vA and vB
+                bool ok = true;
+
+                for (int k=1; k<n && ok; ++k) {
+                    feature_codec::code_t v = alts[k][i];
+
+                    if (v==v0)
+                        ok = false;
+                    else if (nA==0 || v==vA) {
+                        vA = v;
+                        ++nA;
+                    }
+                    else if (nB==0 || v==vB) {
+                        vB = v;
+                        ++nB;
+                    }
+                    else
+                        ok = false;
+                }
+
+                if (!ok || nB==0)
+                    continue;
 
-        // Indeterminate based on one feature, let's try two features
-        for (int i=0; i<m_feat_diffs[0].size(); ++i) {
-            for (int j=i+1; j<m_feat_diffs[0].size(); ++j) {
-            
-                string s0a = at(r, m_feat_diffs[0][i]);
-                string s1a = at(r, m_feat_diffs[1][i]);
-                string s2a = at(r, m_feat_diffs[2][i]);
-                string s3a = at(r, m_feat_diffs[3][i]);
-                string s4a = at(r, m_feat_diffs[4][i]);
-                string s0b = at(r, m_feat_diffs[0][j]);
-                string s1b = at(r, m_feat_diffs[1][j]);
-                string s2b = at(r, m_feat_diffs[2][j]);
-                string s3b = at(r, m_feat_diffs[3][j]);
-                string s4b = at(r, m_feat_diffs[4][j]);
-
-                string s0 = s0a + "." + s0b;
-                string s1 = s1a + "." + s1b;
-                string s2 = s2a + "." + s2b;
-                string s3 = s3a + "." + s3b;
-                string s4 = s4a + "." + s4b;
-
-                if (alldiff(s0,s1,s2,s3,s4))
-                    return m_feat_diff2string.at(i) + "=" + s0a + ","
-                        + m_feat_diff2string.at(j) + "=" + s0b;// + "---53";
+                if (n==3 && (m_threevalues & 1<<i))
+                    hint = equal(i, v0);
+                else if (nB>nA)
+                    hint = not_equal(i, vB) + "," + not_equal(i, vA);
+                else
+                    hint = not_equal(i, vA) + "," + not_equal(i, vB);
+                return true;
             }
         }
 
-        for (auto rc : r)
-            cerr << rc << " ";
-        cerr << "INDETERMINATE 4\n";
-        return "INDETERMINATE 4";
-    }
-
-    
-    string diff6(const vector<string>&r) {
-        // Look for single ≠ selector
-        for (int i=0; i<m_feat_diffs[0].size(); ++i) {
-            string s0 = at(r, m_feat_diffs[0][i]);
-            string s1 = at(r, m_feat_diffs[1][i]);
-            string s2 = at(r, m_feat_diffs[2][i]);
-            string s3 = at(r, m_feat_diffs[3][i]);
-            string s4 = at(r, m_feat_diffs[4][i]);
-            string s5 = at(r, m_feat_diffs[5][i]);
-            
-            if (s0!=s1 && s1==s2 && s1==s3 && s1==s4 && s1==s5)
-                return m_feat_diff2string.at(i) + "≠" + s1;// + "---61";
+        // Look for selector involving two features
+        // (This is tailored to find {feminine nominative, feminine genitive, masculine nominative}
+        // triplets as this is the only relevant case in Nestle1904)
+        if (n==3 && nfeat>=3 &&
+            value(0,alts[0][0])=="feminine"  && value(1,alts[0][1])=="singular" && value(2,alts[0][2])=="nominative" &&
+            value(0,alts[1][0])=="feminine"  && value(1,alts[1][1])=="singular" && value(2,alts[1][2])=="genitive" &&
+            value(0,alts[2][0])=="masculine" && value(1,alts[2][1])=="singular" && value(2,alts[2][2])=="nominative") {
+            hint = m_feat_diff2string.at(0) + "≠masculine," + m_feat_diff2string.at(2) + "≠genitive";
+            return true;
         }
 
         // Indeterminate based on one feature, let's try two features
-        for (int i=0; i<m_feat_diffs[0].size(); ++i) {
-            for (int j=i+1; j<m_feat_diffs[0].size(); ++j) {
-            
-                string s0a = at(r, m_feat_diffs[0][i]);
-                string s1a = at(r, m_feat_diffs[1][i]);
-                string s2a = at(r, m_feat_diffs[2][i]);
-                string s3a = at(r, m_feat_diffs[3][i]);
-                string s4a = at(r, m_feat_diffs[4][i]);
-                string s5a = at(r, m_feat_diffs[5][i]);
-                string s0b = at(r, m_feat_diffs[0][j]);
-                string s1b = at(r, m_feat_diffs[1][j]);
-                string s2b = at(r, m_feat_diffs[2][j]);
-                string s3b = at(r, m_feat_diffs[3][j]);
-                string s4b = at(r, m_feat_diffs[4][j]);
-                string s5b = at(r, m_feat_diffs[5][j]);
-
-                string s0 = s0a + "." + s0b;
-                string s1 = s1a + "." + s1b;
-                string s2 = s2a + "." + s2b;
-                string s3 = s3a + "." + s3b;
-                string s4 = s4a + "." + s4b;
-                string s5 = s5a + "." + s5b;
-
-                if (alldiff(s0,s1,s2,s3,s4,s5))
-                    return m_feat_diff2string.at(i) + "=" + s0a + ","
-                        + m_feat_diff2string.at(j) + "=" + s0b;// + "---63";
+        if (n>=4) {
+            for (int i=0; i<nfeat; ++i) {
+                for (int j=i+1; j<nfeat; ++j) {
+                    uint32_t mask = feature_vector::mask(i) | feature_vector::mask(j);
+
+                    if (none_of(alts.begin()+1, alts.end(), [&](const feature_vector& a) { return a.same(alts[0], mask); })) {
+                        hint = equal(i, alts[0][i]) + "," + equal(j, alts[0][j]);
+                        return true;
+                    }
+                }
             }
         }
 
-        for (auto rc : r)
-            cerr << rc << " ";
-        cerr << "INDETERMINATE 4\n";
-        return "INDETERMINATE 4";
+        hint = "INDETERMINATE " + to_string(min(n-1, 4));
+        return false;
     }
-    
+
   private:
     const vector<vector<int>>& m_feat_diffs;
     const vector<string>& m_feat_diff2string;
-    set<int> m_twovalues;
-    set<int> m_threevalues;
+    vector<feature_codec> m_codecs;
+    uint32_t m_twovalues;   // Bit mask of features
+    uint32_t m_threevalues; // Bit mask of features
 
-    bool alldiff(const string& s1, const string& s2, const string& s3, const string& s4) {
-        return s1!=s2 && s1!=s3 && s1!=s4;// && s2!=s3 && s2!=s4 && s3!=s4;
+    const string& value(int i, feature_codec::code_t c) const {
+        return m_codecs[i].decode(c);
     }
 
-    bool alldiff(const string& s1, const string& s2, const string& s3, const string& s4, const string& s5) {
-        return s1!=s2 && s1!=s3 && s1!=s4 && s1!=s5; // && s2!=s3 && s2!=s4 && s2!=s5 && s3!=s4 && s3!=s5 && s4!=s5;
+    string equal(int i, feature_codec::code_t c) const {
+        return m_feat_diff2string.at(i) + "=" + value(i, c);
     }
 
-    bool alldiff(const string& s1, const string& s2, const string& s3, const string& s4, const string& s5, const string& s6) {
-        return s1!=s2 && s1!=s3 && s1!=s4 && s1!=s5 && s1!=s6;
+    string not_equal(int i, feature_codec::code_t c) const {
+        return m_feat_diff2string.at(i) + "≠" + value(i, c);
     }
 };
 
 
+// Finds the hint for a word with more than one alternative interpretation
+void add_hint(vector<hint>& hints, ostream& err, long self, selector& sel, const vector<string>& row, int count)
+{
+    string text;
+
+    if (!sel.select(sel.encode(row, count), text)) {
+        for (auto rc : row)
+            err << rc << " ";
+        err << text << "\n";
+    }
+
+    hints.push_back({self, text});
+}
+
 
 void tr_gender(string& s)
 {
@@ -451,217 +405,296 @@ void tr_na(string& s)
 }
     
 
-int main(int argc, char **argv)
-{
-    if (argc!=3) {
-        cerr << "usage: hintsdb <emdrosfile> <sqlfile>" << endl;
-        return 1;
-    }
+// The number of monads searched by each Emdros query. The words are retrieved in batches so that
+// only a small part of the corpus is held in memory at a time.
+const int batch_size = 10000;
 
-    ofstream sqlfile{argv[2]};
-    sqlfile << "CREATE TABLE hints (self integer primary key, hint text);\n";
-    sqlfile << "BEGIN TRANSACTION;\n";
+// Generates the hints for nouns
+// Parameters:
+//     EE: The Emdros environment to use
+//     hints: The hints are appended to this vector
+//     err: Diagnostic messages are written to this stream
+// Returns:
+//     False if an error was found
 
-    
-    EmdrosEnv EE{kOKConsole,
-            kCSUTF8,
-            "localhost",
-            "",
-            "",
-            argv[1],
-            kSQLite3};
-
-    bool bResult{false};
-
-    //======================================================================
-    // Handle nouns
-    //======================================================================
-    
-    {
-        selector noun_selector{noun_feat_diffs, noun_feat_diff2string,{1},{0}};
+bool noun_hints(EmdrosEnv& EE, vector<hint>& hints, ostream& err)
+{
+    selector noun_selector{noun_feat_diffs, noun_feat_diff2string,
+                           {feature_codec::from_enum<gender_t>(),
+                            feature_codec::from_enum<number_t>(),
+                            feature_codec::from_enum<case_t>()},
+                           {1}, {0}};
 
-        string csvfile = "GREEK_BibleOL_nominal-ambiguity-project_v1.21.csv";
+    string csvfile = "GREEK_BibleOL_nominal-ambiguity-project_v1.21.csv";
     
-        rapidcsv::Document csv;
-        int csv_row = 0;
-        
-        try {
-            csv.Load(csvfile);
+    csv_table csv;
+
+    if (!csv.load(csvfile, int(cols_nouns::bol_monad_num), err))
+        return false;
+
+    int first_monad, last_monad;
+    if (!monad_range(EE, err, first_monad, last_monad))
+        return false;
+
+    return select_in_batches(EE, err, "[word psp=noun GET self,monad_num,surface,"
+                             "gender,number,case]",
+                             first_monad, last_monad, batch_size,
+                             [&](StrawOk str) {
+        long self = 0;
+        int monad_num;
+        string surface;
+        string_view features[3]; //gender,number,case
+    
+        for (const MatchedObject& mo : str) {
+            self = feature_long(mo, 0);
+            monad_num = feature_long(mo, 1);
+            surface = mo.getFeatureAsString(2);
+            features[0] = morph_info<gender_t>::T2string(feature_enum<gender_t>(mo, 3));
+            features[1] = morph_info<number_t>::T2string(feature_enum<number_t>(mo, 4));
+            features[2] = morph_info<case_t>::T2string(feature_enum<case_t>(mo, 5));
         }
-        catch (const ios_base::failure& e) {
-            cerr << e.what() << "\n";
-            cerr << "Cannot open " << csvfile << "\n";
-            return 1;
+
+        // Each monad is looked up only once, so the row can be modified in place
+        csv_table::row_t* rowp = csv.find(monad_num);
+        if (!rowp) {
+            err << "Monad " << monad_num << " (" << surface << ") is missing from " << csvfile << '\n';
+            return false;
         }
 
-        string mql_request{"SELECT ALL OBJECTS WHERE [word psp=noun GET self,monad_num,surface,"
-            "gender,number,case] GO"};
-    
-        if (!EE.executeString(mql_request, bResult, false, true))
-            return 1;
+        csv_table::row_t& row = *rowp;
 
-        if (!EE.isSheaf()) {
-            cerr << "ERROR: Result is not sheaf\n";
-            return 1;
+    
+        if (surface != at(row,cols_nouns::bol_surface)) {
+            err << "Inconsistency between database and spreadsheet at monad " << at(row,cols_nouns::bol_monad_num) << '\n'
+                << "Spreadsheet has " << at(row,cols_nouns::bol_surface)
+                << " Emdros has " << surface << '\n';
+            return false;
         }
 
-        for (StrawOk str : SheafOk{EE.getSheaf()}) {
-            long self = 0;
-            int monad_num;
-            string surface;
-            string features[3]; //gender,number,case
-        
-            for (const MatchedObject mo : str) {
-                self = mo.getFeatureAsLong(0);
-                monad_num = mo.getFeatureAsLong(1);
-                surface = mo.getFeatureAsString(2);
-                for (int i=0; i<3; ++i)
-                    features[i] = mo.getFeatureAsString(3+i);
+        for (int i=0; i<3; ++i) {
+            if (features[i] != at(row,int(cols_nouns::gn0) + i)) {
+                err << "Inconsistency between database and spreadsheet at monad " << at(row,cols_nouns::bol_monad_num) << " word is " << surface << '\n'
+                    << "Spreadsheet has feature " << i << "=" << at(row,int(cols_nouns::gn0)+i)
+                    << " Emdros has " << features[i] << '\n';
+//            return false;
             }
+        }
 
-            vector<string> row;
+        tr_gender(at(row,cols_nouns::gn1));
+        tr_gender(at(row,cols_nouns::gn2));
+        tr_gender(at(row,cols_nouns::gn3));
+        tr_gender(at(row,cols_nouns::gn4));
+        tr_gender(at(row,cols_nouns::gn5));
 
-            do {
-                row = csv.GetRow<string>(csv_row++);
-            } while (stoi(at(row,cols_nouns::bol_monad_num)) < monad_num);
+        tr_number(at(row,cols_nouns::nu1));
+        tr_number(at(row,cols_nouns::nu2));
+        tr_number(at(row,cols_nouns::nu3));
+        tr_number(at(row,cols_nouns::nu4));
+        tr_number(at(row,cols_nouns::nu5));
 
-        
-            if (surface != at(row,cols_nouns::bol_surface)) {
-                cerr << "Inconsistency between database and spreadsheet at monad " << at(row,cols_nouns::bol_monad_num) << '\n'
-                     << "Spreadsheet has " << at(row,cols_nouns::bol_surface)
-                     << " Emdros has " << surface << '\n';
-                return 1;
-            }
+        tr_case(at(row,cols_nouns::ca1));
+        tr_case(at(row,cols_nouns::ca2));
+        tr_case(at(row,cols_nouns::ca3));
+        tr_case(at(row,cols_nouns::ca4));
+        tr_case(at(row,cols_nouns::ca5));
 
-            for (int i=0; i<3; ++i) {
-                if (features[i] != at(row,int(cols_nouns::gn0) + i)) {
-                    cerr << "Inconsistency between database and spreadsheet at monad " << at(row,cols_nouns::bol_monad_num) << " word is " << surface << '\n'
-                         << "Spreadsheet has feature " << i << "=" << at(row,int(cols_nouns::gn0)+i)
-                         << " Emdros has " << features[i] << '\n';
-//                return 1;
-                }
-            }
 
-            tr_gender(at(row,cols_nouns::gn1));
-            tr_gender(at(row,cols_nouns::gn2));
-            tr_gender(at(row,cols_nouns::gn3));
-            tr_gender(at(row,cols_nouns::gn4));
-            tr_gender(at(row,cols_nouns::gn5));
-
-            tr_number(at(row,cols_nouns::nu1));
-            tr_number(at(row,cols_nouns::nu2));
-            tr_number(at(row,cols_nouns::nu3));
-            tr_number(at(row,cols_nouns::nu4));
-            tr_number(at(row,cols_nouns::nu5));
-
-            tr_case(at(row,cols_nouns::ca1));
-            tr_case(at(row,cols_nouns::ca2));
-            tr_case(at(row,cols_nouns::ca3));
-            tr_case(at(row,cols_nouns::ca4));
-            tr_case(at(row,cols_nouns::ca5));
-
-
-            switch (count_var_nouns(row)) {
-              case 6:
-                    sqlfile << "INSERT INTO hints VALUES(" << self << ",'" << noun_selector.diff6(row) << "');\n";
-                    break;
-              case 5:
-                    sqlfile << "INSERT INTO hints VALUES(" << self << ",'" << noun_selector.diff5(row) << "');\n";
-                    break;
-              case 4:
-                    sqlfile << "INSERT INTO hints VALUES(" << self << ",'" << noun_selector.diff4(row) << "');\n";
-                    break;
-              case 3:
-                    sqlfile << "INSERT INTO hints VALUES(" << self << ",'" << noun_selector.diff3(row) << "');\n";
-                    break;
-              case 2:
-                    sqlfile << "INSERT INTO hints VALUES(" << self << ",'" << noun_selector.diff2(row) << "');\n";
-                    break;
-            }
-        }
-    }
+        int count = count_var_nouns(row);
+        if (count>=2)
+            add_hint(hints, err, self, noun_selector, row, count);
 
-    //======================================================================
-    // Handle verbs
-    //======================================================================
+        return true;
+    });
+}
 
-    {
-         selector verb_selector{verb_feat_diffs, verb_feat_diff2string, {0}, {1}};
+// Generates the hints for verbs
+// Parameters:
+//     EE: The Emdros environment to use
+//     hints: The hints are appended to this vector
+//     err: Diagnostic messages are written to this stream
+// Returns:
+//     False if an error was found
 
-         string csvfile = "AmbigiousVerbalForms20221021_BibleOL-export.csv";
+bool verb_hints(EmdrosEnv& EE, vector<hint>& hints, ostream& err)
+{
+    selector verb_selector{verb_feat_diffs, verb_feat_diff2string,
+                           {feature_codec::from_enum<number_t>(),
+                            feature_codec::from_enum<person_t>(),
+                            feature_codec::from_enum<tense_t>(),
+                            feature_codec::from_enum<mood_t>()},
+                           {0}, {1}};
+
+    string csvfile = "AmbigiousVerbalForms20221021_BibleOL-export.csv";
     
-        rapidcsv::Document csv;
-        int csv_row = 0;
-        
-        try {
-            csv.Load(csvfile);
+    csv_table csv;
+
+    if (!csv.load(csvfile, int(cols_verbs::bol_monad_num), err))
+        return false;
+
+    int first_monad, last_monad;
+    if (!monad_range(EE, err, first_monad, last_monad))
+        return false;
+
+    return select_in_batches(EE, err, "[word psp=verb GET self,monad_num,surface,"
+                             "number,person,tense,voice,mood]",
+                             first_monad, last_monad, batch_size,
+                             [&](StrawOk str) {
+        long self = 0;
+        int monad_num;
+        string surface;
+        string_view features[5]; //number,person,tense,voice,mood
+    
+        for (const MatchedObject& mo : str) {
+            self = feature_long(mo, 0);
+            monad_num = feature_long(mo, 1);
+            surface = mo.getFeatureAsString(2);
+            features[0] = morph_info<number_t>::T2string(feature_enum<number_t>(mo, 3));
+            features[1] = morph_info<person_t>::T2string(feature_enum<person_t>(mo, 4));
+            features[2] = morph_info<tense_t>::T2string(feature_enum<tense_t>(mo, 5));
+            features[3] = morph_info<voice_t>::T2string(feature_enum<voice_t>(mo, 6));
+            features[4] = morph_info<mood_t>::T2string(feature_enum<mood_t>(mo, 7));
         }
-        catch (const ios_base::failure& e) {
-            cerr << e.what() << "\n";
-            cerr << "Cannot open " << csvfile << "\n";
-            return 1;
+
+        // Each monad is looked up only once, so the row can be modified in place
+        csv_table::row_t* rowp = csv.find(monad_num);
+        if (!rowp) {
+            err << "Monad " << monad_num << " (" << surface << ") is missing from " << csvfile << '\n';
+            return false;
         }
 
-        string mql_request{"SELECT ALL OBJECTS WHERE [word psp=verb GET self,monad_num,surface,"
-            "number,person,tense,voice,mood] GO"};
-    
-        if (!EE.executeString(mql_request, bResult, false, true))
-            return 1;
+        csv_table::row_t& row = *rowp;
 
-        if (!EE.isSheaf()) {
-            cerr << "ERROR: Result is not sheaf\n";
-            return 1;
+    
+        if (surface != at(row,cols_verbs::bol_surface)) {
+            err << "Inconsistency between database and spreadsheet at monad " << at(row,cols_verbs::bol_monad_num) << '\n'
+                << "Spreadsheet has " << at(row,cols_verbs::bol_surface)
+                << " Emdros has " << surface << '\n';
+            return false;
         }
 
-        for (StrawOk str : SheafOk{EE.getSheaf()}) {
-            long self = 0;
-            int monad_num;
-            string surface;
-            string features[5]; //number,person,tense,voice,mood
-        
-            for (const MatchedObject mo : str) {
-                self = mo.getFeatureAsLong(0);
-                monad_num = mo.getFeatureAsLong(1);
-                surface = mo.getFeatureAsString(2);
-                for (int i=0; i<5; ++i)
-                    features[i] = mo.getFeatureAsString(3+i);
+        tr_na(at(row,cols_verbs::nu0));
+        tr_na(at(row,cols_verbs::nu1));
+        tr_na(at(row,cols_verbs::pe0));
+        tr_na(at(row,cols_verbs::pe1));
+
+        for (int i=0; i<5; ++i) {
+            if (features[i] != at(row,int(cols_verbs::nu0) + i)) {
+                err << "Inconsistency between database and spreadsheet at monad " << at(row,cols_verbs::bol_monad_num) << " word is " << surface << '\n'
+                    << "Spreadsheet has feature " << i << "=" << at(row,int(cols_verbs::nu0)+i)
+                    << " Emdros has " << features[i] << '\n';
+//            return false;
             }
+        }
 
-            vector<string> row;
+        int count = count_var_verbs(row);
+        if (count>=2)
+            add_hint(hints, err, self, verb_selector, row, count);
 
-            do {
-                row = csv.GetRow<string>(csv_row++);
-            } while (stoi(at(row,cols_verbs::bol_monad_num)) < monad_num);
+        return true;
+    });
+}
 
-        
-            if (surface != at(row,cols_verbs::bol_surface)) {
-                cerr << "Inconsistency between database and spreadsheet at monad " << at(row,cols_verbs::bol_monad_num) << '\n'
-                     << "Spreadsheet has " << at(row,cols_verbs::bol_surface)
-                     << " Emdros has " << surface << '\n';
-                return 1;
-            }
+// A function that generates the hints for one part of speech
+using hint_pass = bool (*)(EmdrosEnv& EE, vector<hint>& hints, ostream& err);
+
+// The passes are independent and may run in parallel
+const vector<hint_pass> passes{ noun_hints, verb_hints };
+
+
+static void usage(const char* progname)
+{
+    cerr << "Usage:\n"
+         << progname << " [-j threads] [-b hintsfile] emdrosfile dbfile\n";
+}
+
+
+
+// Main function. Expects these arguments:
+//     [-j threads] [-b hintsfile] emdrosfile dbfile
+// where
+//     the parts of speech are handled in parallel using the specified number of threads
+//         (default is 1, meaning no parallelism)
+//     -b causes the hints to be written also to a binary hints file (see hints_store.hpp)
+//     emdrosfile is the nestle1904 Emdros database
+//     dbfile is the SQLite hints database to create
 
-            tr_na(at(row,cols_verbs::nu0));
-            tr_na(at(row,cols_verbs::nu1));
-            tr_na(at(row,cols_verbs::pe0));
-            tr_na(at(row,cols_verbs::pe1));
-
-            for (int i=0; i<5; ++i) {
-                if (features[i] != at(row,int(cols_verbs::nu0) + i)) {
-                    cerr << "Inconsistency between database and spreadsheet at monad " << at(row,cols_verbs::bol_monad_num) << " word is " << surface << '\n'
-                         << "Spreadsheet has feature " << i << "=" << at(row,int(cols_verbs::nu0)+i)
-                         << " Emdros has " << features[i] << '\n';
-//                return 1;
+int main(int argc, char **argv)
+{
+    int c;
+    string hints_name;  // Name of binary hints file
+    int threads = 1;    // Number of threads used for the passes
+
+    while ((c = getopt(argc, argv, "j:b:")) != -1) {
+        switch(c) {
+          case 'j':
+                threads = atoi(optarg);
+                if (threads<1) {
+                    usage(argv[0]);
+                    return 1;
                 }
-            }
+                break;
 
-            switch (count_var_verbs(row)) {
-              case 2:
-                    sqlfile << "INSERT INTO hints VALUES(" << self << ",'" << verb_selector.diff2(row) << "');\n";
-                    break;
-            }
+          case 'b':
+                hints_name = optarg;
+                break;
+
+          case '?':
+                usage(argv[0]);
+                return 1;
         }
     }
-    
-    sqlfile << "COMMIT;\n";
+
+    if (argc-optind!=2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    string emdros_name{argv[optind]};
+
+    // Each pass has its own Emdros environment and collects its hints and messages in its own
+    // buffers. With more than one thread, a pool of workers runs the passes in parallel.
+    vector<vector<hint>> pass_hints(passes.size());
+    vector<ostringstream> pass_err(passes.size());
+    vector<char> pass_ok(passes.size(), false);
+    atomic<size_t> next_pass{0};
+
+    auto worker = [&]() {
+        for (size_t p = next_pass++; p<passes.size(); p = next_pass++) {
+            EmdrosEnv EE{kOKConsole,
+                    kCSUTF8,
+                    "localhost",
+                    "",
+                    "",
+                    emdros_name,
+                    kSQLite3};
+
+            pass_ok[p] = passes[p](EE, pass_hints[p], pass_err[p]);
+        }
+    };
+
+    if (threads==1)
+        worker();
+    else {
+        vector<thread> pool;
+        for (int t=0; t<min<int>(threads, passes.size()); ++t)
+            pool.emplace_back(worker);
+        for (thread& t : pool)
+            t.join();
+    }
+
+    vector<hint> hints;
+
+    for (size_t p=0; p<passes.size(); ++p) {
+        cerr << pass_err[p].str();
+        if (!pass_ok[p])
+            return 1;
+
+        hints.insert(hints.end(), pass_hints[p].begin(), pass_hints[p].end());
+    }
+
+    if (!write_hints_db(argv[optind+1], hints))
+        return 1;
+
+    if (!hints_name.empty() && !hints_store::write(hints_name, hints))
+        return 1;
 }
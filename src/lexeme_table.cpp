@@ -0,0 +1,38 @@
+#include <algorithm>
+#include <numeric>
+#include "lexeme_table.hpp"
+
+using namespace std;
+
+// See lexeme_table.hpp for documentation of the functions
+
+
+lexeme_table::id_t lexeme_table::add(string_pool::id_t lemma, int strongs, bool strongs_unreliable)
+{
+    uint64_t key = (uint64_t{lemma} << 32) | (uint64_t(uint32_t(strongs)) << 1) | strongs_unreliable;
+
+    auto [it, inserted] = m_ids.try_emplace(key, m_lexemes.size());
+    if (inserted)
+        m_lexemes.push_back(lexeme{lemma, strongs, strongs_unreliable});
+
+    return it->second;
+}
+
+
+vector<int> frequency_ranks(const vector<int>& counts)
+{
+    vector<int> order(counts.size()); // Item ids sorted by descending count
+    iota(begin(order), end(order), 0);
+    stable_sort(begin(order), end(order), [&counts](int a, int b) { return counts[a] > counts[b]; });
+
+    vector<int> ranks(counts.size());
+
+    for (size_t i=0; i<order.size(); ++i) {
+        if (i>0 && counts[order[i]]==counts[order[i-1]])
+            ranks[order[i]] = ranks[order[i-1]];
+        else
+            ranks[order[i]] = i+1;
+    }
+
+    return ranks;
+}
@@ -0,0 +1,54 @@
+#ifndef _LEXEME_TABLE_HPP
+#define _LEXEME_TABLE_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "string_pool.hpp"
+
+// A lexeme is identified by a lemma, a Strong's number, and a flag indicating if the Strong's
+// number is unreliable.
+struct lexeme {
+    string_pool::id_t lemma;
+    int strongs;
+    bool strongs_unreliable;
+};
+
+
+// Assigns a dense integer id (0, 1, 2, ...) to each distinct lexeme. The ids can be used to index
+// flat arrays of per-lexeme statistics, such as the counts passed to frequency_ranks().
+class lexeme_table {
+  public:
+    using id_t = std::uint32_t;
+
+    // Finds the id of a lexeme, adding the lexeme to the table if it is new.
+    // Parameters:
+    //    lemma: Id of the lemma in the string pool that holds the lemmas
+    //    strongs: Strong's number
+    //    strongs_unreliable: True if the Strong's number is unreliable
+    // Returns:
+    //    The id of the lexeme
+    id_t add(string_pool::id_t lemma, int strongs, bool strongs_unreliable);
+
+    // Retrieves the lexeme with the specified id
+    const lexeme& get(id_t id) const { return m_lexemes[id]; }
+
+    // Retrieves the number of distinct lexemes
+    size_t size() const { return m_lexemes.size(); }
+
+  private:
+    std::vector<lexeme> m_lexemes;                  // id => lexeme
+    std::unordered_map<std::uint64_t, id_t> m_ids;  // Packed lexeme => id
+};
+
+
+// Computes frequency ranks from occurrence counts. The most frequent item has rank 1. Items with
+// the same count share a rank, and the following rank is skipped accordingly, so the counts
+// 7, 5, 5, 3 give the ranks 1, 2, 2, 4.
+// Parameter:
+//    counts: The number of occurrences of each item, indexed by item id
+// Returns:
+//    The rank of each item, indexed by item id
+std::vector<int> frequency_ranks(const std::vector<int>& counts);
+
+#endif // _LEXEME_TABLE_HPP
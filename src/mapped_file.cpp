@@ -0,0 +1,45 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "mapped_file.hpp"
+
+using namespace std;
+
+// See mapped_file.hpp for documentation of the functions
+
+
+mapped_file::mapped_file(const string& filename, access pattern)
+    : m_open{false}, m_data{nullptr}, m_size{0}
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd<0)
+        return;
+
+    struct stat st;
+    if (fstat(fd, &st)==0) {
+        if (st.st_size==0)
+            m_open = true; // Empty file: Nothing to map
+        else {
+            void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p!=MAP_FAILED) {
+                madvise(p, st.st_size,
+                        pattern==access::sequential ? MADV_SEQUENTIAL :
+                        pattern==access::random ? MADV_RANDOM :
+                        MADV_NORMAL);
+                m_data = static_cast<const char*>(p);
+                m_size = st.st_size;
+                m_open = true;
+            }
+        }
+    }
+
+    close(fd); // The mapping stays valid after the file is closed
+}
+
+mapped_file::~mapped_file()
+{
+    if (m_data)
+        munmap(const_cast<char*>(m_data), m_size);
+}
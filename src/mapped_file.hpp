@@ -0,0 +1,44 @@
+#ifndef _MAPPED_FILE_HPP
+#define _MAPPED_FILE_HPP
+
+#include <string>
+#include <string_view>
+
+// Gives read-only access to the contents of a file by mapping it into memory.
+// The data remain valid for as long as the mapped_file object exists.
+class mapped_file {
+  public:
+    // The expected access pattern, passed to the kernel as a hint for its read-ahead
+    enum class access {
+        normal,     // No particular pattern
+        sequential, // The file is read from start to end
+        random,     // The file is read at scattered positions
+    };
+
+    // Constructor. Maps the specified file into memory. Use is_open() to check for success.
+    // Parameters:
+    //    filename: Name of the file to map
+    //    pattern: The expected access pattern
+    mapped_file(const std::string& filename, access pattern = access::sequential);
+
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    // Returns true if the file was successfully mapped
+    bool is_open() const { return m_open; }
+
+    // Retrieves the contents of the file
+    std::string_view view() const { return {m_data, m_size}; }
+
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+  private:
+    bool m_open;
+    const char *m_data;
+    size_t m_size;
+};
+
+#endif // _MAPPED_FILE_HPP
@@ -1,5 +1,7 @@
 #include <iostream>
+#include <unordered_map>
 #include "morph.hpp"
+#include "util.hpp"
 
 
 using namespace std;
@@ -387,3 +389,125 @@ map<noun_declension_t, string> morph_info<noun_declension_t>::m_T2string {
 };
 
 
+/////////////////////////////////////////////////////////////////////////////
+// Decoding of form tags
+/////////////////////////////////////////////////////////////////////////////
+
+static morphology decode_uncached(string_view morph)
+{
+    morphology m;
+
+    m.psp = psp_morph.decode_string(morph);
+  
+    switch (m.psp) {
+      case psp_t::personal_pronoun:
+            if (!morph.empty() && (morph[0]=='1' || morph[0]=='2')) {
+                // Person specified, gender unspecified
+                m.person = person_morph.decode_string(morph);
+                m.case_ = case_morph.decode_string(morph);
+                m.number = number_morph.decode_string(morph);
+                m.gender = gender_t::NA;
+            }
+            else {
+                // 3rd person assumed, gender specified
+                m.person = person_t::third_person;
+                m.case_ = case_morph.decode_string(morph);
+                m.number = number_morph.decode_string(morph);
+                m.gender = gender_morph.decode_string(morph);
+            }
+
+            if (!morph.empty() && morph[0] == '-')
+                m.suffix = suffix_morph.decode_string(morph);
+            break;
+
+
+      case psp_t::possessive_pronoun:
+            m.person = person_morph.decode_string(morph);
+            m.possessor_number = number_morph.decode_string(morph);
+            m.case_ = case_morph.decode_string(morph);
+            m.number = number_morph.decode_string(morph);
+            m.gender = gender_morph.decode_string(morph);
+            break;
+
+      case psp_t::reflexive_pronoun:
+            m.person = person_morph.decode_string(morph);
+            m.case_ = case_morph.decode_string(morph);
+            m.number = number_morph.decode_string(morph);
+            m.gender = gender_morph.decode_string(morph);
+            break;
+
+      case psp_t::noun:
+      case psp_t::adjective:
+      case psp_t::article:
+      case psp_t::reciprocal_pronoun:
+      case psp_t::demonstrative_pronoun:
+      case psp_t::correlative_pronoun:
+      case psp_t::interrogative_pronoun:
+      case psp_t::relative_pronoun:
+      case psp_t::correlative_or_interrogative_pronoun:
+      case psp_t::indefinite_pronoun:
+            m.case_ = case_morph.decode_string(morph);
+            m.number = number_morph.decode_string(morph);
+            m.gender = gender_morph.decode_string(morph);
+
+            if (!morph.empty() && morph[0] == '-')
+                m.suffix = suffix_morph.decode_string(morph);
+            break;
+
+      case psp_t::conjunction:
+      case psp_t::cond:
+      case psp_t::adverb:
+      case psp_t::particle:
+            if (!morph.empty() && morph[0] == '-')
+                m.suffix = suffix_morph.decode_string(morph);
+            break;
+
+      case psp_t::verb:
+            m.tense = tense_morph.decode_string(morph);
+            m.voice = voice_morph.decode_string(morph);
+            m.mood = mood_morph.decode_string(morph);
+
+            switch (m.mood) {
+              case mood_t::indicative:
+              case mood_t::subjunctive:
+              case mood_t::optative:
+              case mood_t::imperative:
+                    assert(!morph.empty() && morph[0]=='-');
+                    morph.remove_prefix(1); // Skip '-'
+                    m.person = person_morph.decode_string(morph);
+                    m.number = number_morph.decode_string(morph);
+                    break;
+
+              case mood_t::infinitive:
+                    break;
+
+              case mood_t::participle:
+              case mood_t::imperative_participle:
+                    assert(!morph.empty() && morph[0]=='-');
+                    morph.remove_prefix(1); // Skip '-'
+                    m.case_ = case_morph.decode_string(morph);
+                    m.number = number_morph.decode_string(morph);
+                    m.gender = gender_morph.decode_string(morph);
+                    break;
+            }
+
+            if (!morph.empty() && morph[0] == '-')
+                m.suffix = suffix_morph.decode_string(morph);
+            break;
+    }
+
+    assert(morph.empty());
+
+    return m;
+}
+
+const morphology& decode_form_tag(string_view form_tag)
+{
+    static unordered_map<string, morphology, string_hash, equal_to<>> cache; // form tag => features
+
+    auto it = cache.find(form_tag);
+    if (it==cache.end())
+        it = cache.emplace(form_tag, decode_uncached(form_tag)).first;
+
+    return it->second;
+}
@@ -5,9 +5,11 @@
 #include <utility>
 #include <map>
 #include <string>
+#include <string_view>
 #include <algorithm>
 #include <iostream>
 #include <cassert>
+#include "mql_output.hpp"
 
 /////////////////////////////////////////////////////////////////////////////
 // class morph_info
@@ -27,23 +29,27 @@ class morph_info {
     //     name: The MQL name of the enumeration.
     morph_info(const std::string& name) : m_name{name} {}
 
-    // Prints an MQL definition of the enumeration type t the specified output stream
-    void create_enum(std::ostream& output) const;
+    // Prints an MQL definition of the enumeration type to the specified output stream
+    void create_enum(mql_output& output) const;
 
     // Converts an enumeration value to its string representation.
+    // The strings are looked up in a table indexed by enumeration value.
     // Parameter:
     //   t: The enumeration value to convert.
-    static std::string T2string(T t);
+    static std::string_view T2string(T t);
+
+    // Retrieves the string representations of all enumeration values, ordered by enumeration value
+    static const std::map<T, std::string>& all_strings() { return m_T2string; }
 
     // Decodes a morphology string.
     // The program aborts if the morphology string does not represent a known enumeration value.
     // Parameter:
     //    morph: The morphology string. The intersting characters must be at the start of this
     //           string. When decoding is done, the converted characters have been stripped from
-    //           morph.
+    //           morph. No characters are copied.
     // Returns:
     //    The enumeration value.
-    static T decode_string(std::string& morph);
+    static T decode_string(std::string_view& morph);
 
   private:
     std::string m_name; // MQL name of enumeration
@@ -57,20 +63,20 @@ class morph_info {
 /////////////////////////////////////////////////////////////////////////////
 
 template<typename T>
-T morph_info<T>::decode_string(std::string& morph)
+T morph_info<T>::decode_string(std::string_view& morph)
 {
     auto found = find_if(begin(m_str2T), end(m_str2T),
                          [morph](const std::pair<std::string,T>& p) {
-                             return morph.substr(0,p.first.size())==p.first;
+                             return morph.starts_with(p.first);
                          });
     assert(found!=end(m_str2T));
 
-    morph = morph.substr(found->first.size());
+    morph.remove_prefix(found->first.size());
     return found->second;
 }
 
 template<typename T>
-void morph_info<T>::create_enum(std::ostream& output) const
+void morph_info<T>::create_enum(mql_output& output) const
 {
     output << "CREATE ENUMERATION " << m_name << " = {\n";
 
@@ -91,9 +97,20 @@ void morph_info<T>::create_enum(std::ostream& output) const
 
 
 template<typename T>
-std::string morph_info<T>::T2string(T t)
+std::string_view morph_info<T>::T2string(T t)
 {
-    return m_T2string.at(t);
+    static const std::vector<std::string_view> names = [] {
+        std::vector<std::string_view> v;
+        for (const auto& x : m_T2string) {
+            size_t ix = static_cast<size_t>(x.first);
+            if (ix>=v.size())
+                v.resize(ix+1);
+            v[ix] = x.second;
+        }
+        return v;
+    }();
+
+    return names.at(static_cast<size_t>(t));
 }
 
 
@@ -274,6 +291,35 @@ enum class noun_declension_t {
     irregular
 };
 
+/////////////////////////////////////////////////////////////////////////////
+// Decoded form tags
+/////////////////////////////////////////////////////////////////////////////
+
+// The morphological features encoded in a form tag such as "V-2AAP-NSM".
+// Features that are not part of the form tag have the value NA.
+struct morphology {
+    psp_t    psp              {psp_t::NA};          // Part of speech
+    case_t   case_            {case_t::NA};
+    number_t number           {number_t::NA};
+    number_t possessor_number {number_t::NA};
+    gender_t gender           {gender_t::NA};
+    person_t person           {person_t::NA};
+    tense_t  tense            {tense_t::NA};
+    voice_t  voice            {voice_t::NA};
+    mood_t   mood             {mood_t::NA};
+    suffix_t suffix           {suffix_t::NA};
+};
+
+// Decodes a form tag.
+// Each distinct form tag is decoded only once; later calls return the cached result.
+// The program aborts if the form tag is malformed.
+// Parameter:
+//    form_tag: The form tag to decode
+// Returns:
+//    The morphological features of the form tag.
+const morphology& decode_form_tag(std::string_view form_tag);
+
+
 /////////////////////////////////////////////////////////////////////////////
 // morph_info objects for the respective enumerations
 /////////////////////////////////////////////////////////////////////////////
@@ -1,11 +1,10 @@
-#include <ostream>
 #include "mql.hpp"
 
 using namespace std;
 
 // Writes the initial information that goes into the MQL file
 
-void mql_header(ostream& output)
+void mql_header(mql_output& output)
 {
     output <<
         "CREATE DATABASE 'nestle1904' GO\n"
@@ -53,7 +52,7 @@ void mql_header(ostream& output)
 
 // Writes the final information that goes into the MQL file
 
-void mql_trailer(ostream& output)
+void mql_trailer(mql_output& output)
 {
     output << "VACUUM DATABASE ANALYZE GO\n";
 }
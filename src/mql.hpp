@@ -2,27 +2,93 @@
 #define _MQL_HPP
 
 #include <vector>
-#include <ostream>
+#include <utility>
+#include <memory>
+#include <thread>
+#include <future>
+#include <atomic>
+#include "mql_output.hpp"
+#include "util.hpp"
 
 
 // Writes the initial information that goes into the MQL file
-void mql_header(std::ostream& output);
+void mql_header(mql_output& output);
 
 // Writes the final information that goes into the MQL file
-void mql_trailer(std::ostream& output);
+void mql_trailer(mql_output& output);
 
 
 // Writes MQL code that generates objects from the data stored in the specified container.
+// If the output has a batch size, the objects are divided into several CREATE OBJECTS statements.
 // Parameter:
 //    container: A vector containing objects that are subclassed from mql_item
 template <typename T>
-void generate_mql_objects(std::ostream& output, const std::vector<T>& container)
+void generate_mql_objects(mql_output& output, const std::vector<T>& container)
 {
     T::trans_start(output);
-    for (const T& obj : container)
-        obj.generate_object(output);
+    for (size_t i=0; i<container.size(); ++i) {
+        if (output.batch_size()>0 && i>0 && i%output.batch_size()==0) {
+            output << "GO\n";
+            T::trans_start(output);
+        }
+        container[i].generate_object(output);
+    }
     T::trans_end(output);
 }
 
+// Writes MQL code that generates objects from the data stored in the specified container, using
+// several threads. The container is divided into parts, each of which is formatted into a separate
+// buffer by a pool of threads. The buffers are written in order, so the output is identical to that
+// of the single threaded version above, except that if the output has a batch size, each part
+// becomes a separate CREATE OBJECTS statement.
+// Parameters:
+//    container: A vector containing objects that are subclassed from mql_item
+//    parts: The parts of the container, given as [first,last) index pairs in container order
+//    threads: The number of threads to use
+//    hashes: If not null, set to the FNV-1a hash of the code of the objects of each part
+template <typename T>
+void generate_mql_objects(mql_output& output, const std::vector<T>& container,
+                          const std::vector<std::pair<size_t,size_t>>& parts, int threads,
+                          std::vector<uint64_t>* hashes = nullptr)
+{
+    std::vector<std::unique_ptr<mql_output>> buffers(parts.size());
+    std::vector<std::promise<void>> done(parts.size());
+    std::atomic<size_t> next_part{0};
+
+    if (hashes)
+        hashes->assign(parts.size(), 0);
+
+    auto worker = [&] {
+        for (size_t p = next_part++; p<parts.size(); p = next_part++) {
+            auto buf = std::make_unique<mql_output>();
+            for (size_t i=parts[p].first; i<parts[p].second; ++i)
+                container[i].generate_object(*buf);
+            if (hashes)
+                (*hashes)[p] = fnv1a(buf->text());
+            buffers[p] = std::move(buf);
+            done[p].set_value();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t=0; t<threads; ++t)
+        pool.emplace_back(worker);
+
+    T::trans_start(output);
+    for (size_t p=0; p<parts.size(); ++p) {
+        if (output.batch_size()>0 && p>0) {
+            output << "GO\n";
+            T::trans_start(output);
+        }
+        done[p].get_future().wait();
+        output << buffers[p]->text();
+        buffers[p].reset(); // Release the memory as soon as possible
+    }
+    T::trans_end(output);
+
+    for (std::thread& t : pool)
+        t.join();
+}
+
 
 #endif //  _MQL_HPP
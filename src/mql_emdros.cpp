@@ -0,0 +1,35 @@
+#include <emdros/emdfdb.h>
+#include <emdros/emdros_environment.h>
+#include <iostream>
+#include <string>
+#include "mql_emdros.hpp"
+
+using namespace std;
+
+// See mql_emdros.hpp for documentation of the functions
+
+
+mql_emdros::mql_emdros()
+    : m_env{new EmdrosEnv{kOKConsole,
+                          kCSUTF8,
+                          "localhost",
+                          "",
+                          "",
+                          "emdf",  // No database selected; same default as the mql program
+                          kSQLite3}}
+{
+}
+
+mql_emdros::~mql_emdros() = default;
+
+bool mql_emdros::execute(string_view mql)
+{
+    bool bResult{false};
+
+    if (!m_env->executeString(string{mql}, bResult, false, true) || !bResult) {
+        cerr << "Emdros failed to execute MQL code" << endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,30 @@
+#ifndef _MQL_EMDROS_HPP
+#define _MQL_EMDROS_HPP
+
+#include <memory>
+#include <string_view>
+
+class EmdrosEnv;
+
+// A connection to Emdros through which MQL statements are executed directly, without going through
+// an MQL file and the mql program. The database is stored using SQLite3.
+class mql_emdros {
+  public:
+    // Constructor. Connects to Emdros without selecting a database; the MQL code is expected to
+    // contain CREATE DATABASE and USE DATABASE statements.
+    mql_emdros();
+
+    ~mql_emdros();
+
+    // Executes MQL statements. Errors are reported on cerr.
+    // Parameter:
+    //    mql: One or more complete MQL statements
+    // Returns:
+    //    True on success, false on error
+    bool execute(std::string_view mql);
+
+  private:
+    std::unique_ptr<EmdrosEnv> m_env;
+};
+
+#endif // _MQL_EMDROS_HPP
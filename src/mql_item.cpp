@@ -25,7 +25,7 @@ void range::add(int i)
 // mql_item
 //////////////////////////////////////////////////////////////////////
 
-void obj_definition::define_obj(ostream& output, const string& objtype, bool single_monad, const vector<obj_definition>& defs)
+void obj_definition::define_obj(mql_output& output, const string& objtype, bool single_monad, const vector<obj_definition>& defs)
 {
     output <<
         "CREATE OBJECT TYPE\n" <<
@@ -53,14 +53,14 @@ void obj_definition::define_obj(ostream& output, const string& objtype, bool sin
 }
 
 
-void mql_item::trans_end(ostream& output, const string& objtype)
+void mql_item::trans_end(mql_output& output, const string& objtype)
 {
     output <<
         "GO\n"
         "CREATE INDEXES ON OBJECT TYPE[" << objtype << "] GO\n\n";
 }
 
-void mql_item::trans_start(ostream& output, const string& objtype)
+void mql_item::trans_start(mql_output& output, const string& objtype)
 {
     output <<
         "CREATE OBJECTS\n"
@@ -71,12 +71,12 @@ void mql_item::trans_start(ostream& output, const string& objtype)
 // mql_book
 //////////////////////////////////////////////////////////////////////
 
-void mql_book::define_obj(ostream& output)
+void mql_book::define_obj(mql_output& output)
 {
     obj_definition::define_obj(output, "book", false, {{"book",    "book_name_t", "Matthew"}});
 }
 
-void mql_book::generate_object(ostream& output) const
+void mql_book::generate_object(mql_output& output) const
 {
     output <<
         "CREATE OBJECT\n"
@@ -91,13 +91,13 @@ void mql_book::generate_object(ostream& output) const
 // mql_chapter
 //////////////////////////////////////////////////////////////////////
 
-void mql_chapter::define_obj(ostream& output)
+void mql_chapter::define_obj(mql_output& output)
 {
     obj_definition::define_obj(output, "chapter", false, {{"book",    "book_name_t", "Matthew"},
                 {"chapter", "integer",     "0"      }});
 }
 
-void mql_chapter::generate_object(ostream& output) const
+void mql_chapter::generate_object(mql_output& output) const
 {
     output <<
         "CREATE OBJECT\n"
@@ -112,14 +112,14 @@ void mql_chapter::generate_object(ostream& output) const
 // mql_verse
 //////////////////////////////////////////////////////////////////////
 
-void mql_verse::define_obj(ostream& output)
+void mql_verse::define_obj(mql_output& output)
 {
     obj_definition::define_obj(output, "verse", false, {{"book",    "book_name_t", "Matthew"},
                                                         {"chapter", "integer",     "0"      },
                                                         {"verse",   "integer",     "0"      }});
 }
 
-void mql_verse::generate_object(ostream& output) const
+void mql_verse::generate_object(mql_output& output) const
 {
     output <<
         "CREATE OBJECT\n"
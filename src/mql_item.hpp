@@ -2,7 +2,9 @@
 #define _MQL_ITEM_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include "mql_output.hpp"
 
 // This class aids in the generation of MQL code for object definition. An object of this class
 // represents the definition of a single feature of an MQL object.
@@ -46,7 +48,7 @@ class obj_definition {
     //    objtype: MQL object type
     //    single_monad: True if the object is a single monad
     //    defs: A vector of feature specfications
-    static void define_obj(std::ostream& output, const std::string& objtype,
+    static void define_obj(mql_output& output, const std::string& objtype,
                            bool single_monad, const std::vector<obj_definition>& defs);
 
   private:
@@ -98,21 +100,24 @@ class mql_item {
     //    monad: The monad to add to the range. This monad must be at most 1 larger than the previous last monad.
     void range_add(int i) { m_range.add(i); }
 
+    // Retrieves the monad range of the object
+    const range& get_range() const { return m_range; }
+
     // Writes an object to the specified output stream.
-    virtual void generate_object(std::ostream& output) const = 0;
+    virtual void generate_object(mql_output& output) const = 0;
 
   protected:
     // Writes MQL code required before the creation of objects
     // Parameters:
     //    output: Output stream for MQL commands.
     //    objtype: The type of the MQL object.
-    static void trans_start(std::ostream& output, const std::string& objtype);
+    static void trans_start(mql_output& output, const std::string& objtype);
 
     // Writes MQL code required after the creation of objects
     // Parameters:
     //    output: Output stream for MQL commands.
     //    objtype: The type of the MQL object.
-    static void trans_end(std::ostream& output, const std::string& objtype);
+    static void trans_end(mql_output& output, const std::string& objtype);
 
     range m_range;
 };
@@ -126,35 +131,38 @@ class mql_book : public mql_item {
     // Parameter:
     //    monad: The first monad in the range
     //    book: The name of the book
-    mql_book(int monad, const std::string& book)
+    mql_book(int monad, std::string_view book)
         : mql_item{monad}, m_book{book} {}
 
     // Writes MQL code required before the creation of objects
     // Parameters:
     //    output: Output stream for MQL commands.
-    static void trans_start(std::ostream& output) { mql_item::trans_start(output, "book"); }
+    static void trans_start(mql_output& output) { mql_item::trans_start(output, "book"); }
 
     // Writes MQL code required after the creation of objects
     // Parameters:
     //    output: Output stream for MQL commands.
-    static void trans_end(std::ostream& output) { mql_item::trans_end(output, "book"); }
+    static void trans_end(mql_output& output) { mql_item::trans_end(output, "book"); }
 
     // Writes CREATE OBJECT TYPE code
     // Parameters:
     //    output: Output stream for MQL commands.
-    static void define_obj(std::ostream& output);
+    static void define_obj(mql_output& output);
 
     // Writes CREATE OBJECT code
     // Parameters:
     //    output: Output stream for MQL commands.
-    virtual void generate_object(std::ostream& output) const override;
+    virtual void generate_object(mql_output& output) const override;
 
     // Determines if a new word belongs to this object.
     // Parameter:
     //    b: Name of the book containing the new word
     // Returns:
     //    True if the new word belongs to this object
-    bool same_object(const std::string& b) const { return m_book==b; }
+    bool same_object(std::string_view b) const { return m_book==b; }
+
+    // Retrieves the name of the book
+    const std::string& get_book() const { return m_book; }
 
   private:
     std::string m_book;
@@ -169,28 +177,28 @@ class mql_chapter : public mql_item {
     //    monad: The first monad in the range
     //    book: The name of the book
     //    chapter: The number of the chapter
-    mql_chapter(int monad, const std::string& book, int chapter)
+    mql_chapter(int monad, std::string_view book, int chapter)
         : mql_item{monad}, m_book{book}, m_chapter{chapter} {}
 
     // Writes MQL code required before the creation of objects
     // Parameters:
     //    output: Output stream for MQL commands.
-    static void trans_start(std::ostream& output) { mql_item::trans_start(output, "chapter"); }
+    static void trans_start(mql_output& output) { mql_item::trans_start(output, "chapter"); }
 
     // Writes MQL code required after the creation of objects
     // Parameters:
     //    output: Output stream for MQL commands.
-    static void trans_end(std::ostream& output) { mql_item::trans_end(output, "chapter"); }
+    static void trans_end(mql_output& output) { mql_item::trans_end(output, "chapter"); }
 
     // Writes CREATE OBJECT TYPE code
     // Parameters:
     //    output: Output stream for MQL commands.
-    static void define_obj(std::ostream& output);
+    static void define_obj(mql_output& output);
 
     // Writes CREATE OBJECT code
     // Parameters:
     //    output: Output stream for MQL commands.
-    virtual void generate_object(std::ostream& output) const override;
+    virtual void generate_object(mql_output& output) const override;
 
     // Determines if a new word belongs to this object.
     // Parameter:
@@ -198,7 +206,7 @@ class mql_chapter : public mql_item {
     //    c: Number of the chapter containing the new word
     // Returns:
     //    True if the new word belongs to this object
-    bool same_object(const std::string& b, int c) const { return m_book==b && m_chapter==c; }
+    bool same_object(std::string_view b, int c) const { return m_book==b && m_chapter==c; }
 
   private:
     std::string m_book;
@@ -215,28 +223,28 @@ class mql_verse : public mql_item {
     //    book: The name of the book
     //    chapter: The number of the chapter
     //    verse: The number of the verse
-    mql_verse(int monad, const std::string& book, int chapter, int verse)
+    mql_verse(int monad, std::string_view book, int chapter, int verse)
         : mql_item{monad}, m_book{book}, m_chapter{chapter}, m_verse{verse} {}
 
     // Writes MQL code required before the creation of objects
     // Parameters:
     //    output: Output stream for MQL commands.
-    static void trans_start(std::ostream& output) { mql_item::trans_start(output, "verse"); }
+    static void trans_start(mql_output& output) { mql_item::trans_start(output, "verse"); }
 
     // Writes MQL code required after the creation of objects
     // Parameters:
     //    output: Output stream for MQL commands.
-    static void trans_end(std::ostream& output) { mql_item::trans_end(output, "verse"); }
+    static void trans_end(mql_output& output) { mql_item::trans_end(output, "verse"); }
 
     // Writes CREATE OBJECT TYPE code
     // Parameters:
     //    output: Output stream for MQL commands.
-    static void define_obj(std::ostream& output);
+    static void define_obj(mql_output& output);
 
     // Writes CREATE OBJECT code
     // Parameters:
     //    output: Output stream for MQL commands.
-    virtual void generate_object(std::ostream& output) const override;
+    virtual void generate_object(mql_output& output) const override;
 
     // Determines if a new word belongs to this object.
     // Parameter:
@@ -245,7 +253,7 @@ class mql_verse : public mql_item {
     //    v: Number of the verse containing the new word
     // Returns:
     //    True if the new word belongs to this object
-    bool same_object(const std::string& b, int c, int v) const { return m_book==b && m_chapter==c && m_verse==v; }
+    bool same_object(std::string_view b, int c, int v) const { return m_book==b && m_chapter==c && m_verse==v; }
 
   private:
     std::string m_book;
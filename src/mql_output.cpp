@@ -0,0 +1,90 @@
+#include <charconv>
+#include <cerrno>
+#include <unistd.h>
+#include "mql_output.hpp"
+
+using namespace std;
+
+// See mql_output.hpp for documentation of the functions
+
+
+mql_output::mql_output(int fd)
+    : m_fd{fd}, m_batch_size{0}, m_next_sink_flush{0}, m_good{true}
+{
+    if (m_fd>=0)
+        m_buffer.reserve(flush_size + flush_size/4);
+}
+
+mql_output::mql_output(statement_sink sink, size_t batch_size)
+    : m_fd{-1}, m_sink{sink}, m_batch_size{batch_size}, m_next_sink_flush{flush_size}, m_good{true}
+{
+}
+
+mql_output::~mql_output()
+{
+    flush();
+}
+
+template<typename INT>
+mql_output& mql_output::append_integer(INT i)
+{
+    char digits[24];
+    auto [end, ec] = to_chars(begin(digits), std::end(digits), i);
+    m_buffer.append(digits, end);
+    check_flush();
+    return *this;
+}
+
+template mql_output& mql_output::append_integer<int>(int i);
+template mql_output& mql_output::append_integer<long>(long i);
+
+void mql_output::flush()
+{
+    if (m_sink) {
+        if (m_good && !m_buffer.empty())
+            m_good = m_sink(m_buffer);
+        m_buffer.clear();
+        return;
+    }
+
+    if (m_fd<0)
+        return;
+
+    const char *p = m_buffer.data();
+    size_t left = m_buffer.size();
+
+    while (left>0 && m_good) {
+        ssize_t written = write(m_fd, p, left);
+        if (written<0) {
+            if (errno!=EINTR)
+                m_good = false;
+        }
+        else {
+            p += written;
+            left -= written;
+        }
+    }
+
+    m_buffer.clear();
+}
+
+void mql_output::flush_statements()
+{
+    // A statement ends with the keyword GO followed by a newline
+    size_t go = m_buffer.rfind("GO\n");
+    while (go!=string::npos && go>0 && m_buffer[go-1]!='\n' && m_buffer[go-1]!=' ')
+        go = m_buffer.rfind("GO\n", go-1);
+
+    if (go==string::npos) {
+        // No complete statement yet. Don't search again until more text has arrived.
+        m_next_sink_flush = m_buffer.size() + flush_size;
+        return;
+    }
+
+    size_t end = go+3;
+
+    if (m_good)
+        m_good = m_sink(string_view{m_buffer}.substr(0, end));
+    m_buffer.erase(0, end);
+    m_next_sink_flush = m_buffer.size() + flush_size;
+}
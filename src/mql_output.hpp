@@ -0,0 +1,81 @@
+#ifndef _MQL_OUTPUT_HPP
+#define _MQL_OUTPUT_HPP
+
+#include <string>
+#include <string_view>
+#include <functional>
+
+// Output stream for MQL code.
+// Text and numbers are formatted into a large buffer, which is written to a file descriptor in big
+// chunks when it fills up. Alternatively, the buffer can be passed to a statement sink, such as an
+// Emdros database connection; in that case the buffer is only emptied up to the end of the last
+// complete statement. An mql_output without a file descriptor or a sink just collects the text in
+// memory.
+class mql_output {
+  public:
+    // A function that executes complete MQL statements. It returns false on error.
+    using statement_sink = std::function<bool(std::string_view)>;
+
+    // Constructor.
+    // Parameter:
+    //    fd: The file descriptor to write to, or -1 to keep the text in memory
+    mql_output(int fd = -1);
+
+    // Constructor.
+    // Parameters:
+    //    sink: The function that executes the MQL statements
+    //    batch_size: The maximum number of objects created by a single CREATE OBJECTS statement
+    mql_output(statement_sink sink, size_t batch_size);
+
+    // Destructor. Flushes the buffer.
+    ~mql_output();
+
+    mql_output(const mql_output&) = delete;
+    mql_output& operator=(const mql_output&) = delete;
+
+    mql_output& operator<<(std::string_view s) { m_buffer.append(s); check_flush(); return *this; }
+    mql_output& operator<<(char c) { m_buffer.push_back(c); check_flush(); return *this; }
+    mql_output& operator<<(int i) { return append_integer(i); }
+    mql_output& operator<<(long i) { return append_integer(i); }
+
+    // Writes the buffer to the file descriptor or passes it to the sink. Does nothing if there is
+    // neither a file descriptor nor a sink.
+    void flush();
+
+    // Returns false if writing to the file descriptor or executing statements has failed
+    bool good() const { return m_good; }
+
+    // Retrieves the text collected by an mql_output without a file descriptor
+    std::string_view text() const { return m_buffer; }
+
+    // Retrieves the maximum number of objects that may be created by a single CREATE OBJECTS
+    // statement. 0 means no limit.
+    size_t batch_size() const { return m_batch_size; }
+
+  private:
+    static constexpr size_t flush_size = 1<<20; // Flush when the buffer holds this many characters
+
+    void check_flush() {
+        if (m_buffer.size()>=flush_size) {
+            if (m_fd>=0)
+                flush();
+            else if (m_sink && m_buffer.size()>=m_next_sink_flush)
+                flush_statements();
+        }
+    }
+
+    // Passes the complete statements in the buffer to the sink
+    void flush_statements();
+
+    template<typename INT>
+    mql_output& append_integer(INT i);
+
+    int m_fd;
+    statement_sink m_sink;
+    size_t m_batch_size;
+    size_t m_next_sink_flush; // Buffer size at which flush_statements() should look for statements again
+    bool m_good;
+    std::string m_buffer;
+};
+
+#endif // _MQL_OUTPUT_HPP
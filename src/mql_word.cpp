@@ -1,5 +1,4 @@
 #include <iostream>
-#include <tuple>
 #include <map>
 #include <algorithm>
 #include <cassert>
@@ -13,63 +12,69 @@ using namespace std;
 // See mql_word.hpp for documentation of the functions
 
 
+// The text fields of all words and the stripped variants of lemmas and normalized forms.
+// References, form tags and lemmas repeat constantly, so each distinct string is stored (and
+// stripped) only once.
+static string_pool strings;
+static strip_cache raw_cache{strings};
 
+// All distinct <lemma,strongs,strongs_unreliable> triples
+static lexeme_table lexeme_ids;
 
-mql_word::mql_word(int monad, const string& line)
+
+
+mql_word::mql_word(int monad, string_view line)
     : mql_item{monad},
       m_verb_type{verb_type_t::NA}, 
       m_noun_stem{noun_stem_t::NA},
       m_noun_declension{noun_declension_t::NA}
 {
-    string strongs_string;
+    auto [ref, surface, functional_tag, form_tag, strongs_string, lemma, normalized] = split_fields<7>(line);
 
-    tie(m_ref, m_surface, m_functional_tag, m_form_tag, strongs_string, m_lemma, m_normalized) = split7(line);
+    m_ref = strings.intern(ref);
+    m_surface = strings.intern(surface);
+    m_functional_tag = strings.intern(functional_tag);
+    m_form_tag = strings.intern(form_tag);
+    m_lemma = strings.intern(lemma);
+    m_normalized = strings.intern(normalized);
 
-    m_strongs = stoi(strongs_string); // Discards optional second value
-    m_strongs_unreliable = strongs_string[0]=='0';
+    m_strongs = view_to_int(strongs_string.substr(0, strongs_string.find('&'))); // Discards optional second value
+    m_strongs_unreliable = strongs_string.starts_with('0');
 
     // Error in text:
     if (m_strongs==11391)
         m_strongs = 1391;
 
-    decode_morphology();
+    m_lexeme = lexeme_ids.add(m_lemma, m_strongs, m_strongs_unreliable);
+
+    m_raw_lemma = raw_cache.stripped(m_lemma);
+    m_raw_normalized = raw_cache.stripped(m_normalized);
+
+    m_morph = decode_form_tag(form_tag);
 }
 
-void mql_word::set_freq(vector<mql_word>& words)
+const string_pool& mql_word::string_table()
 {
-    map<tuple<string,int,bool>,int> lemmacount;	 // <lemma,strongs,strongs_unreliable> => count
-	map<tuple<string,int,bool>,int> lemmarank;	 // <lemma,strongs,strongs_unreliable> => rank
-    multimap<int,tuple<string,int,bool>,greater<int>> freq2lemma; // frequency => <lemma,strongs,strongs_unreliable>,
-                                                                  // sorted by descending frequency
-
-    for (const mql_word& w : words)
-        ++lemmacount[tuple{w.m_lemma, w.m_strongs, w.m_strongs_unreliable}];
+    return strings;
+}
 
-    for (const auto& me : lemmacount)
-        freq2lemma.insert(make_pair(me.second, me.first));
+const lexeme_table& mql_word::lexemes()
+{
+    return lexeme_ids;
+}
 
-    // Use frequencies to generate frequency ranks
+void mql_word::set_freq(vector<mql_word>& words)
+{
+    vector<int> lemmacount(lexeme_ids.size()); // Lexeme id => count
 
-    int rank = 1;		// Current rank
-    int last_freq = 0;	// Last frequency inserted
-    int last_rank = 0;	// Rank of last frequency inserted
+    for (const mql_word& w : words)
+        ++lemmacount[w.m_lexeme];
 
-    for (const auto& p : freq2lemma) {
-        // p.first is frequency, p.second is <lemma,variant,part_of_speech>
-        if (p.first==last_freq)
-            lemmarank[p.second] = last_rank;
-        else {
-            lemmarank[p.second] = rank;
-            last_freq = p.first;
-            last_rank = rank;
-        }
-        ++rank;
-    }
+    vector<int> lemmarank{frequency_ranks(lemmacount)}; // Lexeme id => rank
 
     for (mql_word& w : words) {
-        auto key = tuple{w.m_lemma, w.m_strongs, w.m_strongs_unreliable};
-        w.m_lexeme_occurrences = lemmacount[key];
-        w.m_frequency_rank = lemmarank[key];
+        w.m_lexeme_occurrences = lemmacount[w.m_lexeme];
+        w.m_frequency_rank = lemmarank[w.m_lexeme];
     }
 }
 
@@ -78,15 +83,15 @@ void mql_word::set_inflection(vector<mql_word>& words)
     read_inflection_spreadsheets();
 
     for (mql_word& w : words) {
-        auto key = w.m_lemma + "," + to_string(w.m_strongs) + "," + (w.m_strongs_unreliable ? "true" : "false");
+        auto key = string{w.get_lemma()} + "," + to_string(w.m_strongs) + "," + (w.m_strongs_unreliable ? "true" : "false");
 
-        if (w.m_psp == psp_t::noun) {
+        if (w.m_morph.psp == psp_t::noun) {
             assert(noun_stem_map.contains(key));
             assert(noun_decl_map.contains(key));
             w.m_noun_stem = noun_stem_map[key];
             w.m_noun_declension = noun_decl_map[key];
         }
-        else if (w.m_psp == psp_t::verb) {
+        else if (w.m_morph.psp == psp_t::verb) {
             assert(verb_type_map.contains(key));
             w.m_verb_type = verb_type_map[key];
         }
@@ -95,7 +100,7 @@ void mql_word::set_inflection(vector<mql_word>& words)
 
 
 
-void mql_word::define_obj(ostream& output)
+void mql_word::define_obj(mql_output& output)
 {
     psp_morph.create_enum(output);   
     case_morph.create_enum(output);  
@@ -138,32 +143,32 @@ void mql_word::define_obj(ostream& output)
                                                       { "monad_num", "integer", "0" }});
 }
 
-void mql_word::generate_object(ostream& output) const
+void mql_word::generate_object(mql_output& output) const
 {
     output <<
         "CREATE OBJECT\n"
         "FROM MONADS= { " << m_range.get_first() << " }\n"
         "[\n"
-        "    ref := \""              << m_ref                                              << "\";\n"
-        "    surface := \""          << m_surface                                          << "\";\n"
-        "    functional_tag := \""   << m_functional_tag                                   << "\";\n"
-        "    form_tag := \""         << m_form_tag                                         << "\";\n"
+        "    ref := \""              << get_ref()                                          << "\";\n"
+        "    surface := \""          << get_surface()                                      << "\";\n"
+        "    functional_tag := \""   << get_functional_tag()                               << "\";\n"
+        "    form_tag := \""         << get_form_tag()                                     << "\";\n"
         "    strongs := "            << m_strongs                                          << ";\n"
         "    strongs_unreliable := " <<(m_strongs_unreliable ? "true" : "false")           << ";\n"
-        "    lemma := \""            << m_lemma                                            << "\";\n"
-        "    raw_lemma := \""        << strip_string(m_lemma)                              << "\";\n"
-        "    normalized := \""       << m_normalized                                       << "\";\n"
-        "    raw_normalized := \""   << strip_string(m_normalized)                         << "\";\n"
-        "    psp := "                << psp_morph.T2string(m_psp)                          << ";\n"
-        "    case := "               << case_morph.T2string(m_case)                        << ";\n"
-        "    number := "             << number_morph.T2string(m_number)                    << ";\n"
-        "    possessor_number := "   << number_morph.T2string(m_possessor_number)          << ";\n"
-        "    gender := "             << gender_morph.T2string(m_gender)                    << ";\n"
-        "    person := "             << person_morph.T2string(m_person)                    << ";\n"
-        "    tense := "              << tense_morph.T2string(m_tense)                      << ";\n"
-        "    voice := "              << voice_morph.T2string(m_voice)                      << ";\n"
-        "    mood := "               << mood_morph.T2string(m_mood)                        << ";\n"
-        "    suffix := "             << suffix_morph.T2string(m_suffix)                    << ";\n"
+        "    lemma := \""            << get_lemma()                                        << "\";\n"
+        "    raw_lemma := \""        << get_raw_lemma()                                    << "\";\n"
+        "    normalized := \""       << get_normalized()                                   << "\";\n"
+        "    raw_normalized := \""   << get_raw_normalized()                               << "\";\n"
+        "    psp := "                << psp_morph.T2string(m_morph.psp)                    << ";\n"
+        "    case := "               << case_morph.T2string(m_morph.case_)                 << ";\n"
+        "    number := "             << number_morph.T2string(m_morph.number)              << ";\n"
+        "    possessor_number := "   << number_morph.T2string(m_morph.possessor_number)    << ";\n"
+        "    gender := "             << gender_morph.T2string(m_morph.gender)              << ";\n"
+        "    person := "             << person_morph.T2string(m_morph.person)              << ";\n"
+        "    tense := "              << tense_morph.T2string(m_morph.tense)                << ";\n"
+        "    voice := "              << voice_morph.T2string(m_morph.voice)                << ";\n"
+        "    mood := "               << mood_morph.T2string(m_morph.mood)                  << ";\n"
+        "    suffix := "             << suffix_morph.T2string(m_morph.suffix)              << ";\n"
         "    verb_type := "          << verb_type_morph.T2string(m_verb_type)              << ";\n"
         "    noun_stem := "          << noun_stem_morph.T2string(m_noun_stem)              << ";\n"
         "    noun_declension := "    << noun_declension_morph.T2string(m_noun_declension)  << ";\n"
@@ -173,109 +178,3 @@ void mql_word::generate_object(ostream& output) const
         "]\n";
 }
 
-
-void mql_word::decode_morphology()
-{
-    string morph{m_form_tag};
-
-    m_psp = psp_morph.decode_string(morph);
-  
-    switch (m_psp) {
-      case psp_t::personal_pronoun:
-            if (morph[0]=='1' || morph[0]=='2') {
-                // Person specified, gender unspecified
-                m_person = person_morph.decode_string(morph);
-                m_case = case_morph.decode_string(morph);
-                m_number = number_morph.decode_string(morph);
-                m_gender = gender_t::NA;
-            }
-            else {
-                // 3rd person assumed, gender specified
-                m_person = person_t::third_person;
-                m_case = case_morph.decode_string(morph);
-                m_number = number_morph.decode_string(morph);
-                m_gender = gender_morph.decode_string(morph);
-            }
-
-            if (!morph.empty() && morph[0] == '-')
-                m_suffix = suffix_morph.decode_string(morph);
-            break;
-
-
-      case psp_t::possessive_pronoun:
-            m_person = person_morph.decode_string(morph);
-            m_possessor_number = number_morph.decode_string(morph);
-            m_case = case_morph.decode_string(morph);
-            m_number = number_morph.decode_string(morph);
-            m_gender = gender_morph.decode_string(morph);
-            break;
-
-      case psp_t::reflexive_pronoun:
-            m_person = person_morph.decode_string(morph);
-            m_case = case_morph.decode_string(morph);
-            m_number = number_morph.decode_string(morph);
-            m_gender = gender_morph.decode_string(morph);
-            break;
-
-      case psp_t::noun:
-      case psp_t::adjective:
-      case psp_t::article:
-      case psp_t::reciprocal_pronoun:
-      case psp_t::demonstrative_pronoun:
-      case psp_t::correlative_pronoun:
-      case psp_t::interrogative_pronoun:
-      case psp_t::relative_pronoun:
-      case psp_t::correlative_or_interrogative_pronoun:
-      case psp_t::indefinite_pronoun:
-            m_case = case_morph.decode_string(morph);
-            m_number = number_morph.decode_string(morph);
-            m_gender = gender_morph.decode_string(morph);
-
-            if (!morph.empty() && morph[0] == '-')
-                m_suffix = suffix_morph.decode_string(morph);
-            break;
-
-      case psp_t::conjunction:
-      case psp_t::cond:
-      case psp_t::adverb:
-      case psp_t::particle:
-            if (!morph.empty() && morph[0] == '-')
-                m_suffix = suffix_morph.decode_string(morph);
-            break;
-
-      case psp_t::verb:
-            m_tense = tense_morph.decode_string(morph);
-            m_voice = voice_morph.decode_string(morph);
-            m_mood = mood_morph.decode_string(morph);
-
-            switch (m_mood) {
-              case mood_t::indicative:
-              case mood_t::subjunctive:
-              case mood_t::optative:
-              case mood_t::imperative:
-                    assert(morph[0]=='-');
-                    morph = morph.substr(1); // Skip '-'
-                    m_person = person_morph.decode_string(morph);
-                    m_number = number_morph.decode_string(morph);
-                    break;
-
-              case mood_t::infinitive:
-                    break;
-
-              case mood_t::participle:
-              case mood_t::imperative_participle:
-                    assert(morph[0]=='-');
-                    morph = morph.substr(1); // Skip '-'
-                    m_case = case_morph.decode_string(morph);
-                    m_number = number_morph.decode_string(morph);
-                    m_gender = gender_morph.decode_string(morph);
-                    break;
-            }
-
-            if (!morph.empty() && morph[0] == '-')
-                m_suffix = suffix_morph.decode_string(morph);
-            break;
-    }
-
-    assert(morph.empty());
-}
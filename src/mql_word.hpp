@@ -3,6 +3,8 @@
 
 #include "mql_item.hpp"
 #include "morph.hpp"
+#include "string_pool.hpp"
+#include "lexeme_table.hpp"
 
 
 
@@ -13,30 +15,47 @@ class mql_word : public mql_item {
     // Parameter:
     //    monad: The first monad in the range
     //    line: The line read from the bible text file
-    mql_word(int monad, const std::string& line);
+    mql_word(int monad, std::string_view line);
 
     // Writes MQL code required before the creation of objects
     // Parameters:
     //    output: Output stream for MQL commands.
-    static void trans_start(std::ostream& output) { mql_item::trans_start(output, "word"); }
+    static void trans_start(mql_output& output) { mql_item::trans_start(output, "word"); }
 
     // Writes MQL code required after the creation of objects
     // Parameters:
     //    output: Output stream for MQL commands.
-    static void trans_end(std::ostream& output) { mql_item::trans_end(output, "word"); }
+    static void trans_end(mql_output& output) { mql_item::trans_end(output, "word"); }
 
     // Writes CREATE OBJECT TYPE code
     // Parameters:
     //    output: Output stream for MQL commands.
-    static void define_obj(std::ostream& output);
+    static void define_obj(mql_output& output);
 
     // Writes CREATE OBJECT code
     // Parameters:
     //    output: Output stream for MQL commands.
-    virtual void generate_object(std::ostream& output) const override;
+    virtual void generate_object(mql_output& output) const override;
 
-    // Retrieves the Bible reference
-    std::string get_ref() const { return m_ref; }
+    // Retrieves the text fields of the word. The strings are stored in string_table().
+    std::string_view get_ref() const            { return string_table().get(m_ref); }
+    std::string_view get_surface() const        { return string_table().get(m_surface); }
+    std::string_view get_functional_tag() const { return string_table().get(m_functional_tag); }
+    std::string_view get_form_tag() const       { return string_table().get(m_form_tag); }
+    std::string_view get_lemma() const          { return string_table().get(m_lemma); }
+    std::string_view get_raw_lemma() const      { return string_table().get(m_raw_lemma); }
+    std::string_view get_normalized() const     { return string_table().get(m_normalized); }
+    std::string_view get_raw_normalized() const { return string_table().get(m_raw_normalized); }
+
+    // Retrieves the pool that holds the text fields of all words
+    static const string_pool& string_table();
+
+    // Retrieves the lexeme of the word. The id refers to lexemes().
+    lexeme_table::id_t get_lexeme() const { return m_lexeme; }
+
+    // Retrieves the table of all lexemes, which assigns the ids returned by get_lexeme().
+    // Per-lexeme statistics can be computed by counting into a vector indexed by these ids.
+    static const lexeme_table& lexemes();
 
     // Generates occurrences and frequency rank
     static void set_freq(std::vector<mql_word>& words);
@@ -45,27 +64,19 @@ class mql_word : public mql_item {
     static void set_inflection(std::vector<mql_word>& words);
 
   private:
-    // Decodes the morphology string.
-    void decode_morphology();
-
-    std::string m_ref;
-    std::string m_surface;
-    std::string m_functional_tag;
-    std::string m_form_tag;
+    // The text fields are ids of strings in string_table()
+    string_pool::id_t m_ref;
+    string_pool::id_t m_surface;
+    string_pool::id_t m_functional_tag;
+    string_pool::id_t m_form_tag;
     int         m_strongs;
     bool        m_strongs_unreliable;
-    std::string m_lemma;
-    std::string m_normalized;
-    psp_t       m_psp;          // Part of speech
-    case_t      m_case;
-    number_t    m_number;
-    number_t    m_possessor_number;
-    gender_t    m_gender;
-    person_t    m_person;
-    tense_t     m_tense;
-    voice_t     m_voice;
-    mood_t      m_mood;
-    suffix_t    m_suffix;
+    string_pool::id_t m_lemma;
+    string_pool::id_t m_normalized;
+    string_pool::id_t m_raw_lemma;      // Stripped lemma
+    string_pool::id_t m_raw_normalized; // Stripped normalized form
+    lexeme_table::id_t m_lexeme;        // <lemma,strongs,strongs_unreliable>
+    morphology  m_morph;        // Features decoded from m_form_tag
     verb_type_t m_verb_type;
     noun_stem_t m_noun_stem;
     noun_declension_t m_noun_declension;
@@ -1,18 +1,29 @@
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <algorithm>
 #include <tuple>
 #include <map>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <atomic>
 #include <unistd.h>
+#include <fcntl.h>
 #include "mql_item.hpp"
 #include "mql_word.hpp"
 #include "mql.hpp"
+#include "mql_emdros.hpp"
+#include "mapped_file.hpp"
+#include "util.hpp"
+#include "book_fingerprints.hpp"
 
 
 using namespace std;
 
 
+// Maximum number of objects created by one CREATE OBJECTS statement when executing MQL directly
+static constexpr size_t emdros_batch_size = 10000;
+
 // The MQL objects:
 static vector<mql_word> words;
 static vector<mql_book> books;
@@ -27,9 +38,9 @@ static vector<mql_verse> verses;
 // Returns:
 //    A tuple containing book name (using the Emdros enumeration), chapter, and verse.
 
-static tuple<string,int,int> split_ref(const string& s)
+static tuple<string_view,int,int> split_ref(string_view s)
 {
-    static map<string,string> book_names {
+    static map<string,string,less<>> book_names {
         {"Matt",   "Matthew"},
         {"Mark",   "Mark"},
         {"Luke",   "Luke"},
@@ -59,27 +70,214 @@ static tuple<string,int,int> split_ref(const string& s)
         {"Rev",    "Revelation"},
     };
 
-    auto it1 = find(begin(s),end(s),' ');
-    auto it2 = find(it1+1,end(s),':');
+    size_t space = s.find(' ');
+    size_t colon = s.find(':', space);
+
+    auto book = book_names.find(s.substr(0, space));
+    if (book==book_names.end()) {
+        cerr << "Unknown book in reference " << s << endl;
+        exit(1);
+    }
+
+    return make_tuple(string_view{book->second},
+                      view_to_int(s.substr(space+1, colon-space-1)),
+                      view_to_int(s.substr(colon+1)));
+}
+
+
+// The objects belonging to one book, given as [first,last) index ranges in the object vectors
+struct book_extent {
+    size_t book;
+    size_t words_first, words_last;
+    size_t chapters_first, chapters_last;
+    size_t verses_first, verses_last;
+    int first_monad, last_monad;
+};
+
+// Finds the objects belonging to each book
+static vector<book_extent> find_book_extents()
+{
+    vector<book_extent> extents;
+    size_t c = 0;
+    size_t v = 0;
+
+    for (size_t b=0; b<books.size(); ++b) {
+        book_extent e;
+        e.book = b;
+        e.first_monad = books[b].get_range().get_first();
+        e.last_monad = books[b].get_range().get_last();
+        e.words_first = e.first_monad-1;
+        e.words_last = e.last_monad;
+
+        e.chapters_first = c;
+        while (c<chapters.size() && chapters[c].get_range().get_last()<=e.last_monad)
+            ++c;
+        e.chapters_last = c;
+
+        e.verses_first = v;
+        while (v<verses.size() && verses[v].get_range().get_last()<=e.last_monad)
+            ++v;
+        e.verses_last = v;
+
+        extents.push_back(e);
+    }
+
+    return extents;
+}
+
+
+// Retrieves the [first,last) index range in words of each book
+static vector<pair<size_t,size_t>> word_parts(const vector<book_extent>& extents)
+{
+    vector<pair<size_t,size_t>> parts;
+    for (const book_extent& e : extents)
+        parts.emplace_back(e.words_first, e.words_last);
+    return parts;
+}
+
+
+// Calculates the hashes of the MQL code of the words of each book without writing the code. The
+// books are processed in parallel.
+// Parameters:
+//    extents: The objects belonging to each book
+//    threads: The number of threads to use
+// Returns:
+//    The FNV-1a hash of the CREATE OBJECT code of the words of each book
+
+static vector<uint64_t> calculate_word_hashes(const vector<book_extent>& extents, int threads)
+{
+    vector<uint64_t> hashes(extents.size());
+    atomic<size_t> next_book{0};
+
+    auto worker = [&] {
+        for (size_t b = next_book++; b<extents.size(); b = next_book++) {
+            mql_output buf;
+            for (size_t i=extents[b].words_first; i<extents[b].words_last; ++i)
+                words[i].generate_object(buf);
+            hashes[b] = fnv1a(buf.text());
+        }
+    };
+
+    vector<thread> pool;
+    for (int t=0; t<threads; ++t)
+        pool.emplace_back(worker);
+    for (thread& t : pool)
+        t.join();
+
+    return hashes;
+}
+
+
+// Calculates the fingerprints of the MQL code. The fingerprint of a book is the hash of the
+// CREATE OBJECT code of its words, book, chapters, and verses.
+// Parameters:
+//    extents: The objects belonging to each book
+//    word_hashes: The hash of the code of the words of each book. The code of the words is by far
+//                 the largest part, so it is hashed while it is generated.
+// Returns:
+//    The fingerprints
+
+static book_fingerprints calculate_fingerprints(const vector<book_extent>& extents,
+                                                const vector<uint64_t>& word_hashes)
+{
+    book_fingerprints fp;
+
+    mql_output schema;
+    mql_header(schema);
+    mql_word::define_obj(schema);
+    mql_book::define_obj(schema);
+    mql_chapter::define_obj(schema);
+    mql_verse::define_obj(schema);
+    fp.set_schema(fnv1a(schema.text()));
+
+    for (size_t b=0; b<extents.size(); ++b) {
+        const book_extent& e = extents[b];
+
+        mql_output buf;
+        books[e.book].generate_object(buf);
+        for (size_t i=e.chapters_first; i<e.chapters_last; ++i)
+            chapters[i].generate_object(buf);
+        for (size_t i=e.verses_first; i<e.verses_last; ++i)
+            verses[i].generate_object(buf);
+
+        fp.add_book(books[e.book].get_book(), e.first_monad, e.last_monad, fnv1a(buf.text(), word_hashes[b]));
+    }
+
+    return fp;
+}
+
+
+// Writes MQL code that replaces the objects of one type within a monad range of an existing
+// database.
+// Parameters:
+//    output: Output stream for MQL commands
+//    objtype: The type of the MQL objects
+//    container: A vector containing objects that are subclassed from mql_item
+//    first, last: The [first,last) index range of the new objects in container
+//    e: The book whose objects are replaced
+
+template <typename T>
+static void replace_objects(mql_output& output, const char* objtype, const vector<T>& container,
+                            size_t first, size_t last, const book_extent& e)
+{
+    output << "DELETE OBJECTS BY MONADS = { " << e.first_monad << "-" << e.last_monad << " }"
+           << "[" << objtype << "] GO\n";
+
+    if (first==last)
+        return;
+
+    T::trans_start(output);
+    for (size_t i=first; i<last; ++i) {
+        if (output.batch_size()>0 && i>first && (i-first)%output.batch_size()==0) {
+            output << "GO\n";
+            T::trans_start(output);
+        }
+        container[i].generate_object(output);
+    }
+    output << "GO\n\n";
+}
+
+
+// Writes MQL code that replaces the objects of the changed books in an existing database
+static void generate_update(mql_output& output, const vector<book_extent>& extents, const vector<size_t>& changed)
+{
+    output << "USE DATABASE 'nestle1904' GO\n\n";
+
+    for (size_t b : changed) {
+        const book_extent& e = extents[b];
+
+        replace_objects(output, "word", words, e.words_first, e.words_last, e);
+        replace_objects(output, "book", books, e.book, e.book+1, e);
+        replace_objects(output, "chapter", chapters, e.chapters_first, e.chapters_last, e);
+        replace_objects(output, "verse", verses, e.verses_first, e.verses_last, e);
+    }
 
-    return make_tuple(book_names.at(string{begin(s),it1}),
-                      stoi(string{it1+1,it2}),
-                      stoi(string{it2+1,end(s)}));
+    mql_trailer(output);
 }
 
 
 static void usage(const char* progname)
 {
     cerr << "Usage:\n"
-         << progname << " [-o mqlfile] bibletext\n";
+         << progname << " [-o mqlfile | -e] [-j threads] [-f fingerprintfile | -u fingerprintfile] bibletext\n";
 }
         
 
 
 // Main function. Expects these arguments:
-//     [-o mqlfile] bibletext
+//     [-o mqlfile | -e] [-j threads] [-f fingerprintfile | -u fingerprintfile] bibletext
 // where
-//     the generated MQL code is written to mqlfile (cout if -o is not given)
+//     the generated MQL code is written to mqlfile (cout if neither -o nor -e is given)
+//     -e causes the generated MQL code to be executed directly by Emdros
+//     the words of each book are formatted in parallel using the specified number of threads
+//         (default is 1, meaning no parallelism)
+//     -f causes the fingerprints of the books to be written to fingerprintfile
+//     -u causes MQL code to be generated that updates an existing database, replacing only the
+//         books whose fingerprints differ from those in fingerprintfile. With -e, the fingerprint
+//         file is then updated. Otherwise the new fingerprints are written to fingerprintfile.new,
+//         which the caller should rename to fingerprintfile when the code has been applied. If the
+//         database cannot be updated book by book (for example, because words have been added), no
+//         code is generated and the program exits with status 2
 //     bibletext is the name of a csv file containing the Bible text
 
 int main(int argc, char **argv)
@@ -88,13 +286,18 @@ int main(int argc, char **argv)
 
     int c;
     bool oflag = false;
+    bool eflag = false;
     string output_name;  // Name of MQL file
     string text_name;    // Name of Bible text file
+    int threads = 1;     // Number of threads used for formatting words
+    bool fflag = false;
+    bool uflag = false;
+    string fingerprint_name; // Name of fingerprint file
 
-    while ((c = getopt(argc, argv, "o:")) != -1) {
+    while ((c = getopt(argc, argv, "o:ej:f:u:")) != -1) {
         switch(c) {
           case 'o':
-                if (oflag) {
+                if (oflag || eflag) {
                     usage(argv[0]);
                     return 1;
                 }
@@ -102,6 +305,34 @@ int main(int argc, char **argv)
                 oflag = true;
                 output_name = optarg;
                 break;
+
+          case 'e':
+                if (oflag || eflag) {
+                    usage(argv[0]);
+                    return 1;
+                }
+
+                eflag = true;
+                break;
+
+          case 'j':
+                threads = atoi(optarg);
+                if (threads<1) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+
+          case 'f':
+          case 'u':
+                if (fflag || uflag) {
+                    usage(argv[0]);
+                    return 1;
+                }
+
+                (c=='f' ? fflag : uflag) = true;
+                fingerprint_name = optarg;
+                break;
                 
           case '?':
                 usage(argv[0]);
@@ -117,37 +348,50 @@ int main(int argc, char **argv)
     }
 
 
-    ofstream ofile;
+    int ofd = 1; // Standard output
     if (oflag) {
-        ofile.open(output_name);
-        if (!ofile) {
+        ofd = open(output_name.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0666);
+        if (ofd<0) {
             cerr << "Cannot open " << output_name << endl;
             return 1;
         }
     }
 
-    ostream& output = oflag ? ofile : cout; // References output stream
+    unique_ptr<mql_emdros> emdros;
+    unique_ptr<mql_output> output_ptr;
 
-    ifstream bible_text{text_name};   // Bible text file stream
-    if (!bible_text) {
+    if (eflag) {
+        emdros = make_unique<mql_emdros>();
+        output_ptr = make_unique<mql_output>([&emdros](string_view mql) { return emdros->execute(mql); },
+                                             emdros_batch_size);
+    }
+    else
+        output_ptr = make_unique<mql_output>(ofd);
+
+    mql_output& output = *output_ptr;
+
+    mapped_file bible_text{text_name};   // Bible text file contents
+    if (!bible_text.is_open()) {
         cerr << "Cannot open " << text_name << endl;
         return 1;
     }
 
+    string_view text = bible_text.view();
 
-    string line;
+    words.reserve(count(begin(text), end(text), '\n') + 1);
 
     // Read text from csv file
-    while (getline(bible_text, line)) {
+    while (!text.empty()) {
+        size_t eol = text.find('\n');
+        string_view line = text.substr(0, eol);
+        text.remove_prefix(eol==string_view::npos ? text.size() : eol+1);
+
         int monad = words.size() + 1;
 
         words.emplace_back(monad, line);
         mql_word& w = words.back();
 
-        string book;
-        int chapter;
-        int verse;
-        tie(book, chapter, verse) = split_ref(w.get_ref());
+        auto [book, chapter, verse] = split_ref(w.get_ref());
 
         add_monad(books, monad, book);
         add_monad(chapters, monad, book, chapter);
@@ -163,22 +407,79 @@ int main(int argc, char **argv)
     mql_word::set_inflection(words);
 
     
+    book_fingerprints fingerprints;
+    vector<book_extent> extents = find_book_extents();
+    vector<size_t> changed; // Indexes of changed books
+
+    // For an update, the fingerprints are needed to find the changed books before any code is
+    // generated. For a full build, they are calculated while the code is generated.
+    if (uflag) {
+        fingerprints = calculate_fingerprints(extents, calculate_word_hashes(extents, threads));
+
+        book_fingerprints old_fingerprints;
+        if (!old_fingerprints.load(fingerprint_name)) {
+            cerr << "Cannot read " << fingerprint_name << ". Full rebuild required" << endl;
+            return 2;
+        }
+
+        if (!fingerprints.changed_books(old_fingerprints, changed)) {
+            cerr << "The books cannot be updated individually. Full rebuild required" << endl;
+            return 2;
+        }
+
+        cerr << changed.size() << " book(s) changed" << endl;
+    }
+
+
     // Generate MQL
 
-    mql_header(output);
+    if (uflag) {
+        if (!changed.empty())
+            generate_update(output, extents, changed);
+    }
+    else {
+        mql_header(output);
+
+        // Define enumerations
+        mql_word::define_obj(output);
+        mql_book::define_obj(output);
+        mql_chapter::define_obj(output);
+        mql_verse::define_obj(output);
 
-    // Define enumerations
-    mql_word::define_obj(output);
-    mql_book::define_obj(output);
-    mql_chapter::define_obj(output);
-    mql_verse::define_obj(output);
 
+        // Create objects
+        if (fflag) {
+            vector<uint64_t> word_hashes;
+            generate_mql_objects(output, words, word_parts(extents), threads, &word_hashes);
+            fingerprints = calculate_fingerprints(extents, word_hashes);
+        }
+        else if (threads>1)
+            generate_mql_objects(output, words, word_parts(extents), threads);
+        else
+            generate_mql_objects(output, words);
+        generate_mql_objects(output, books);
+        generate_mql_objects(output, chapters);
+        generate_mql_objects(output, verses);
+
+        mql_trailer(output);
+    }
 
-    // Create objects
-    generate_mql_objects(output, words);
-    generate_mql_objects(output, books);
-    generate_mql_objects(output, chapters);
-    generate_mql_objects(output, verses);
+    output.flush();
+    if (!output.good()) {
+        cerr << (eflag ? "Error executing MQL code" : "Error writing MQL code") << endl;
+        return 1;
+    }
 
-    mql_trailer(output);
+    if (oflag)
+        close(ofd);
+
+    if (fflag || uflag) {
+        // The fingerprint file must describe the database, so when the update code is not
+        // executed here, the new fingerprints are kept apart until the code has been applied
+        string name = uflag && !eflag ? fingerprint_name + ".new" : fingerprint_name;
+        if (!fingerprints.save(name)) {
+            cerr << "Cannot write " << name << endl;
+            return 1;
+        }
+    }
 }
@@ -0,0 +1,42 @@
+#include <algorithm>
+#include "string_pool.hpp"
+
+using namespace std;
+
+// See string_pool.hpp for documentation of the functions
+
+
+string_pool::id_t string_pool::intern(string_view s)
+{
+    auto it = m_ids.find(s);
+    if (it!=m_ids.end())
+        return it->second;
+
+    if (s.size()>m_block_left) {
+        size_t size = max(s.size(), m_block_size);
+        m_blocks.emplace_back(new char[size]);
+        m_next = m_blocks.back().get();
+        m_block_left = size;
+    }
+
+    copy(begin(s), end(s), m_next);
+    string_view stored{m_next, s.size()};
+    m_next += s.size();
+    m_block_left -= s.size();
+
+    id_t id = m_strings.size();
+    m_strings.push_back(stored);
+    m_ids.emplace(stored, id);
+
+    return id;
+}
+
+bool string_pool::find(string_view s, id_t& id) const
+{
+    auto it = m_ids.find(s);
+    if (it==m_ids.end())
+        return false;
+
+    id = it->second;
+    return true;
+}
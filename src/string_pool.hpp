@@ -0,0 +1,55 @@
+#ifndef _STRING_POOL_HPP
+#define _STRING_POOL_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Stores each distinct string once and identifies it by a 32-bit id.
+// The characters are kept in large blocks that are never moved or freed while the pool exists, so
+// the string_views handed out by the pool remain valid for the lifetime of the pool.
+class string_pool {
+  public:
+    using id_t = std::uint32_t;
+
+    // Constructor.
+    // Parameter:
+    //    block_size: The size of the character blocks. Longer strings get a block of their own.
+    string_pool(size_t block_size = 1<<20) : m_block_size{block_size}, m_block_left{0}, m_next{nullptr} {}
+
+    string_pool(const string_pool&) = delete;
+    string_pool& operator=(const string_pool&) = delete;
+
+    // Adds a string to the pool unless it is already there.
+    // Parameter:
+    //    s: The string to add
+    // Returns:
+    //    The id of the string
+    id_t intern(std::string_view s);
+
+    // Finds the id of a string without adding it.
+    // Parameters:
+    //    s: The string to look for
+    //    id: Set to the id of the string if it is found
+    // Returns:
+    //    True if the string is in the pool
+    bool find(std::string_view s, id_t& id) const;
+
+    // Retrieves the string with the specified id
+    std::string_view get(id_t id) const { return m_strings[id]; }
+
+    // Retrieves the number of distinct strings in the pool
+    size_t size() const { return m_strings.size(); }
+
+  private:
+    size_t m_block_size;
+    size_t m_block_left;                              // Free characters in the current block
+    char *m_next;                                     // Next free character in the current block
+    std::vector<std::unique_ptr<char[]>> m_blocks;    // Character storage
+    std::vector<std::string_view> m_strings;          // id => string
+    std::unordered_map<std::string_view, id_t> m_ids; // string => id
+};
+
+#endif // _STRING_POOL_HPP
@@ -1,4 +1,8 @@
 #include <map>
+#include <array>
+#include <algorithm>
+#include <stdexcept>
+#include <charconv>
 #include "util.hpp"
 #include "strip.hpp"
 
@@ -6,7 +10,9 @@ using namespace std;
 
 // Maps Greek characters to their lower case unaccented variant.
 // An 'X' value indicates that the character should be removed from the word.
-static map<char32_t, char32_t> stripmap {
+// strip_string() does not search this table directly; it is used to fill the flat lookup tables
+// in strip_tables below.
+static const pair<char32_t, char32_t> stripmap[] {
     { U'\u0020', U'\u0020' },   // space
     { U'\u0028', U'X' },        // (
     { U'\u0029', U'X' },        // )
@@ -349,27 +355,153 @@ static map<char32_t, char32_t> stripmap {
 };
 
 
+// Flat lookup tables built from stripmap. A 0 entry indicates that the character is not in
+// stripmap.
+class strip_tables {
+  public:
+    strip_tables() : m_ascii{}, m_greek{}, m_greek_ext{} {
+        for (const auto& [from, to] : stripmap) {
+            if (from<0x80)
+                m_ascii[from] = to;
+            else if (from>=greek_first && from<greek_first+m_greek.size())
+                m_greek[from-greek_first] = to;
+            else if (from>=greek_ext_first && from<greek_ext_first+m_greek_ext.size())
+                m_greek_ext[from-greek_ext_first] = to;
+            else
+                m_other[from] = to;
+        }
+    }
+
+    // Finds the replacement of a character. Throws out_of_range if the character is unknown.
+    char32_t at(char32_t c) const {
+        char32_t r;
+
+        if (c<0x80)
+            r = m_ascii[c];
+        else if (c>=greek_first && c<greek_first+m_greek.size())
+            r = m_greek[c-greek_first];
+        else if (c>=greek_ext_first && c<greek_ext_first+m_greek_ext.size())
+            r = m_greek_ext[c-greek_ext_first];
+        else
+            r = m_other.at(c);
+
+        if (r==0) {
+            char hex[8];
+            auto [end, ec] = to_chars(begin(hex), std::end(hex), (unsigned long)c, 16);
+            throw out_of_range("strip_string: Unknown character U+" + string(hex, end));
+        }
+
+        return r;
+    }
+
+  private:
+    static constexpr char32_t greek_first = 0x0370;     // Greek and Coptic block
+    static constexpr char32_t greek_ext_first = 0x1f00; // Greek Extended block
+
+    array<char32_t, 0x80> m_ascii;
+    array<char32_t, 0x90> m_greek;     // U+0370 to U+03FF
+    array<char32_t, 0x100> m_greek_ext; // U+1F00 to U+1FFF
+    map<char32_t, char32_t> m_other;   // Everything else (a few punctuation characters)
+};
+
+static const strip_tables tables;
+
+
+// Decodes the UTF-8 character starting at s[i] and advances i past it
+static char32_t next_char(string_view s, size_t& i)
+{
+    unsigned char ch0 {(unsigned char)s[i]};
+
+    if ((ch0 & 0x80) == 0) {
+        i += 1;
+        return ch0;
+    }
+    else if ((ch0 & 0xe0) == 0xc0 && i+1<s.size()) {
+        char32_t c = ((ch0 & 0x1f) << 6) | (s[i+1] & 0x3f);
+        i += 2;
+        return c;
+    }
+    else if ((ch0 & 0xf0) == 0xe0 && i+2<s.size()) {
+        char32_t c = ((ch0 & 0x0f) << 12) | ((s[i+1] & 0x3f) << 6) | (s[i+2] & 0x3f);
+        i += 3;
+        return c;
+    }
+    else if ((ch0 & 0xf8) == 0xf0 && i+3<s.size()) {
+        char32_t c = ((ch0 & 0x07) << 18) | ((s[i+1] & 0x3f) << 12) | ((s[i+2] & 0x3f) << 6) | (s[i+3] & 0x3f);
+        i += 4;
+        return c;
+    }
+    else
+        throw out_of_range("strip_string: Bad UTF-8 string");
+}
+
+// Appends the UTF-8 encoding of c to result. c is always below U+0800 here.
+static void append_char(string& result, char32_t c)
+{
+    if (c<=0x7f)
+        result.push_back(c);
+    else {
+        result.push_back((c >> 6) | 0xc0);
+        result.push_back((c & 0x3f) | 0x80);
+    }
+}
+
+
+// Removes non-letters from string and replaces characters with lower case unaccented variants.
+// Arguments:
+//   s: Source string
+//   result: The modified string is stored here
+
+void strip_string(string_view s, string& result)
+{
+    result.clear();
+
+    size_t i = 0;
+    while (i<s.size()) {
+        // Remove trailing " (I)" and " (II)"
+        if (s[i]==' ') {
+            if (s.substr(i).starts_with(" (I)")) {
+                i += 4;
+                continue;
+            }
+            if (s.substr(i).starts_with(" (II)")) {
+                i += 5;
+                continue;
+            }
+        }
+
+        // Replace with unaccented lower case characters
+        char32_t r {tables.at(next_char(s, i))};
+        if (r!=U'X')
+            append_char(result, r);
+    }
+}
+
+
 // Removes non-letters from string and replaces characters with lower case unaccented variants.
 // Argument:
 //   s: Source string
 // Returns:
 //   Modified string
 
-string strip_string(const string& s)
+string strip_string(string_view s)
 {
-    u32string source {u8_to_u32(s)};
-    u32string result;
+    string result;
+    strip_string(s, result);
+    return result;
+}
 
-    // Remove trailing " (I)" and " (II)"
-    replace_string_in_place(source, U" (I)", U"");
-    replace_string_in_place(source, U" (II)", U"");
 
-    // Replace with unaccented lower case characters
-    for (char32_t c : source) {
-        char32_t r {stripmap.at(c)};
-        if (r!=U'X')
-            result.push_back(r);
+string_pool::id_t strip_cache::stripped(string_pool::id_t id)
+{
+    if (id>=m_stripped.size())
+        m_stripped.resize(max<size_t>(id+1, m_pool.size()), not_stripped);
+
+    if (m_stripped[id]==not_stripped) {
+        strip_string(m_pool.get(id), m_buffer);
+        string_pool::id_t result = m_pool.intern(m_buffer);
+        m_stripped[id] = result;
     }
 
-    return u32_to_u8(result);
+    return m_stripped[id];
 }
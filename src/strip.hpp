@@ -2,12 +2,47 @@
 #define _STRIP_HPP
 
 #include <string>
+#include <string_view>
+#include <vector>
+#include "string_pool.hpp"
 
 // Removes non-letters from string and replaces characters with lower case unaccented variants.
 // Argument:
 //   s: Source string
 // Returns:
 //   Modified string
-std::string strip_string(const std::string& s);
+std::string strip_string(std::string_view s);
+
+// Removes non-letters from string and replaces characters with lower case unaccented variants.
+// This version reuses the memory of the caller's result string.
+// Arguments:
+//   s: Source string
+//   result: The modified string is stored here
+void strip_string(std::string_view s, std::string& result);
+
+
+// Caches the stripped variants of the strings in a string_pool so that each distinct string is
+// stripped only once. The stripped strings are stored in the same pool.
+class strip_cache {
+  public:
+    // Constructor.
+    // Parameter:
+    //    pool: The pool holding the original and the stripped strings
+    strip_cache(string_pool& pool) : m_pool{pool} {}
+
+    // Finds the stripped variant of a pooled string, stripping it if this has not been done before.
+    // Parameter:
+    //    id: The id of the original string
+    // Returns:
+    //    The id of the stripped string
+    string_pool::id_t stripped(string_pool::id_t id);
+
+  private:
+    static constexpr string_pool::id_t not_stripped = -1;
+
+    string_pool& m_pool;
+    std::vector<string_pool::id_t> m_stripped; // Original id => stripped id or not_stripped
+    std::string m_buffer;                      // Work area for strip_string
+};
 
 #endif // _STRIP_HPP
@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <charconv>
+#include <stdexcept>
 
 #include "util.hpp"
 
@@ -143,22 +145,12 @@ tuple<string,string,string,string,string,string> split6(const string& s)
                       string{it5+1,it6});
 }
 
-// Splits the string s into 7 components. The components are separated by the tab character.
-tuple<string,string,string,string,string,string,string> split7(const string& s)
+// Converts s to an integer. Throws invalid_argument if s is not a decimal number.
+int view_to_int(string_view s)
 {
-    auto it1 = find(begin(s),end(s),'\t');
-    auto it2 = find(it1+1,end(s),'\t');
-    auto it3 = find(it2+1,end(s),'\t');
-    auto it4 = find(it3+1,end(s),'\t');
-    auto it5 = find(it4+1,end(s),'\t');
-    auto it6 = find(it5+1,end(s),'\t');
-    auto it7 = find(it6+1,end(s),'\t');
-
-    return make_tuple(string{begin(s),it1},
-                      string{it1+1,it2},
-                      string{it2+1,it3}, 
-                      string{it3+1,it4}, 
-                      string{it4+1,it5}, 
-                      string{it5+1,it6}, 
-                      string{it6+1,it7});
+    int result = 0;
+    auto [ptr, ec] = from_chars(s.data(), s.data()+s.size(), result);
+    if (ec!=errc{} || ptr!=s.data()+s.size())
+        throw invalid_argument{"Invalid number \"" + string{s} + "\""};
+    return result;
 }
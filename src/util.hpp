@@ -1,8 +1,12 @@
 #ifndef _UTIL_H
 #define _UTIL_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <array>
 #include <tuple>
+#include <functional>
 
 // Converts a UTF-8 string to a UTF-32 string
 std::u32string u8_to_u32(const std::string& s);
@@ -32,7 +36,47 @@ bool ends_with(const std::string& full_string, const std::string& ending);
 // Splits the string s into 6 components. The components are separated by the tab character.
 std::tuple<std::string,std::string,std::string,std::string,std::string,std::string> split6(const std::string& s);
 
-// Splits the std::string s into 7 components. The components are separated by the tab character.
-std::tuple<std::string,std::string,std::string,std::string,std::string,std::string,std::string> split7(const std::string& s);
+// Splits the string s into N components. The components are separated by the tab character.
+// The components refer to the characters of s, which must therefore outlive them.
+template<size_t N>
+std::array<std::string_view,N> split_fields(std::string_view s)
+{
+    std::array<std::string_view,N> result;
+
+    for (size_t i=0; i<N; ++i) {
+        size_t tab = s.find('\t');
+        result[i] = s.substr(0, tab);
+        s.remove_prefix(tab==std::string_view::npos ? s.size() : tab+1);
+    }
+
+    return result;
+}
+
+// Hash function for unordered containers with std::string keys. It allows lookup with a
+// std::string_view or a const char* without constructing a temporary std::string.
+// Use it together with std::equal_to<>.
+struct string_hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+// Converts s to an integer.
+// Throws std::invalid_argument if s is not a decimal number. Leading spaces and trailing characters
+// are not allowed.
+int view_to_int(std::string_view s);
+
+// Computes the 64-bit FNV-1a hash of a sequence of bytes. Unlike std::hash, the result is the same
+// in every run and on every platform, so it can be stored in files.
+// Parameters:
+//    s: The bytes to hash
+//    h: The hash of the preceding bytes, when data is hashed in several pieces
+inline uint64_t fnv1a(std::string_view s, uint64_t h = 0xcbf29ce484222325)
+{
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001b3;
+    }
+    return h;
+}
 
 #endif // _UTIL_H